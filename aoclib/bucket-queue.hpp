@@ -0,0 +1,325 @@
+#pragma once
+
+#include <bit>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+    Monotone min-priority queues for integer priorities (e.g. Dijkstra with integer edge costs, where the priorities are
+    never smaller than the last extracted one), with the same interface as PrioQueue (insert, update_prio,
+    insert_or_update, extract_min, contains), but for dense element ids in [0, num_ids) instead of arbitrary elements,
+    so finding an element's position is an array lookup. Both support decrease-key (update_prio) in O(1): The element is
+    removed from its bucket (swapped with the bucket's last element) and pushed into the bucket of its new priority.
+    - RadixHeap: Bucket i holds the priorities which first differ from the last extracted priority in bit i - 1, so there
+      are only bit-width + 1 buckets; extract_min redistributes the smallest non-empty bucket when bucket 0 is empty
+      (every element moves to lower buckets at most bit-width times, hence amortised O(log C) per element, C: the
+      largest difference between priorities in the queue).
+      cf. https://ssp.impulsetrain.com/radix-heap.html (last retrieved 2024-12-20)
+    - DialQueue: Circular array of max_step + 1 (rounded up to a power of two) buckets, one per priority: All priorities in
+      the queue lie in [last extracted, last extracted + max_step], so bucket prio % num_buckets only holds one priority at a
+      time. extract_min scans forward to the next non-empty bucket (amortised O(1) for small max_step, e.g. day 16: 1000).
+      cf. https://en.wikipedia.org/wiki/Bucket_queue#Applications (Dial's algorithm; last retrieved 2024-12-20)
+    Inserting a priority below the last extracted one (or too far above it for DialQueue) throws std::invalid_argument.
+*/
+
+namespace aocutil
+{
+namespace bucket_queue_impl
+{
+constexpr uint32_t NOT_QUEUED = std::numeric_limits<uint32_t>::max();
+
+// Buckets of element ids; every queued element knows its bucket and its index in the bucket.
+class Buckets
+{
+    std::vector<std::vector<uint32_t>> buckets;
+    std::vector<uint32_t> bucket_of, idx_in_bucket; // By element id.
+
+public:
+    Buckets(std::size_t num_buckets, std::size_t num_ids) : buckets(num_buckets), bucket_of(num_ids, NOT_QUEUED), idx_in_bucket(num_ids, 0)
+    {
+        if (num_ids >= NOT_QUEUED) {
+            throw std::invalid_argument("Buckets::Buckets: Too many ids");
+        }
+    }
+
+    std::size_t num_ids() const {
+        return bucket_of.size();
+    }
+    bool contains(uint32_t id) const {
+        return bucket_of[id] != NOT_QUEUED;
+    }
+    std::vector<uint32_t>& operator[](std::size_t bucket) {
+        return buckets[bucket];
+    }
+    const std::vector<uint32_t>& operator[](std::size_t bucket) const {
+        return buckets[bucket];
+    }
+
+    void push(std::size_t bucket, uint32_t id)
+    {
+        bucket_of[id] = static_cast<uint32_t>(bucket);
+        idx_in_bucket[id] = static_cast<uint32_t>(buckets[bucket].size());
+        buckets[bucket].push_back(id);
+    }
+
+    void remove(uint32_t id)
+    {
+        std::vector<uint32_t>& bucket = buckets[bucket_of[id]];
+        const uint32_t last = bucket.back();
+        bucket[idx_in_bucket[id]] = last;
+        idx_in_bucket[last] = idx_in_bucket[id];
+        bucket.pop_back();
+        bucket_of[id] = NOT_QUEUED;
+    }
+
+    uint32_t pop(std::size_t bucket)
+    {
+        const uint32_t id = buckets[bucket].back();
+        buckets[bucket].pop_back();
+        bucket_of[id] = NOT_QUEUED;
+        return id;
+    }
+
+    void clear()
+    {
+        for (auto& bucket : buckets) {
+            for (uint32_t id : bucket) {
+                bucket_of[id] = NOT_QUEUED;
+            }
+            bucket.clear();
+        }
+    }
+};
+}
+
+template<typename PrioType = int>
+class RadixHeap
+{
+private:
+    static_assert(std::is_integral_v<PrioType>);
+    using UPrio = std::make_unsigned_t<PrioType>;
+    static constexpr int NUM_BUCKETS = std::numeric_limits<UPrio>::digits + 1;
+
+    bucket_queue_impl::Buckets buckets;
+    std::vector<PrioType> prios; // By element id (only valid while queued).
+    std::vector<uint32_t> redistributed; // The bucket being redistributed by extract_min (a member to reuse its allocation).
+    PrioType last = 0; // Last extracted priority (the minimum of all queued priorities).
+    std::size_t size_ = 0;
+
+    int bucket_idx(PrioType prio) const {
+        return std::bit_width(static_cast<UPrio>(prio) ^ static_cast<UPrio>(last));
+    }
+
+    // Checked before the element is removed from its old bucket (so a failed update leaves it queued).
+    void check_prio(PrioType prio) const
+    {
+        if (prio < last) {
+            throw std::invalid_argument("RadixHeap: Priority smaller than the last extracted one");
+        }
+    }
+
+    void push(uint32_t id, PrioType prio)
+    {
+        prios[id] = prio;
+        buckets.push(bucket_idx(prio), id);
+    }
+
+public:
+    explicit RadixHeap(std::size_t num_ids) : buckets(NUM_BUCKETS, num_ids), prios(num_ids) {}
+
+    void insert(uint32_t id, PrioType prio)
+    {
+        if (buckets.contains(id)) {
+            throw std::invalid_argument("RadixHeap insert: Element already in queue");
+        }
+        check_prio(prio);
+        push(id, prio);
+        ++size_;
+    }
+
+    void update_prio(uint32_t id, PrioType new_prio)
+    {
+        if (!buckets.contains(id)) {
+            throw std::out_of_range("RadixHeap update_prio: Element not in queue");
+        }
+        check_prio(new_prio);
+        buckets.remove(id);
+        push(id, new_prio);
+    }
+
+    void insert_or_update(uint32_t id, PrioType prio)
+    {
+        if (buckets.contains(id)) {
+            check_prio(prio);
+            buckets.remove(id);
+            push(id, prio);
+        } else {
+            insert(id, prio);
+        }
+    }
+
+    uint32_t extract_min(PrioType& prio)
+    {
+        if (size_ == 0) {
+            throw std::out_of_range("RadixHeap extract_min: Queue already empty");
+        }
+        if (buckets[0].empty()) { // Redistribute the first non-empty bucket relative to its minimum.
+            int i = 1;
+            while (buckets[i].empty()) {
+                ++i;
+            }
+            PrioType new_last = std::numeric_limits<PrioType>::max();
+            for (uint32_t id : buckets[i]) {
+                new_last = std::min(new_last, prios[id]);
+            }
+            last = new_last;
+            std::swap(redistributed, buckets[i]); // Every element moves to a lower bucket.
+            for (uint32_t id : redistributed) {
+                buckets.push(bucket_idx(prios[id]), id);
+            }
+            redistributed.clear();
+        }
+        --size_;
+        prio = last;
+        return buckets.pop(0);
+    }
+
+    uint32_t extract_min()
+    {
+        PrioType prio;
+        return extract_min(prio);
+    }
+
+    bool contains(uint32_t id) const {
+        return buckets.contains(id);
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    // Empties the queue (and allows priorities below the last extracted one again).
+    void clear()
+    {
+        buckets.clear();
+        size_ = 0;
+        last = 0;
+    }
+};
+
+template<typename PrioType = int>
+class DialQueue
+{
+private:
+    static_assert(std::is_integral_v<PrioType>);
+
+    std::size_t mask; // Number of buckets - 1.
+    PrioType max_step_;
+    bucket_queue_impl::Buckets buckets;
+    PrioType last = 0; // Last extracted priority.
+    std::size_t size_ = 0;
+
+    static std::size_t num_buckets(PrioType max_step)
+    {
+        if (max_step < 0 || static_cast<std::size_t>(max_step) >= (std::size_t{1} << 30)) {
+            throw std::invalid_argument("DialQueue::DialQueue: Invalid max_step");
+        }
+        return std::bit_ceil(static_cast<std::size_t>(max_step) + 1);
+    }
+
+    void check_prio(PrioType prio) const
+    {
+        if (prio < last || prio - last > max_step_) {
+            throw std::invalid_argument("DialQueue: Priority out of range [last extracted, last extracted + max_step]");
+        }
+    }
+
+    void push(uint32_t id, PrioType prio)
+    {
+        buckets.push(static_cast<std::size_t>(prio) & mask, id);
+    }
+
+public:
+    // max_step: The largest difference between a queued priority and the last extracted one (e.g. the largest edge cost).
+    DialQueue(std::size_t num_ids, PrioType max_step)
+        : mask{num_buckets(max_step) - 1}, max_step_{max_step}, buckets(mask + 1, num_ids) {}
+
+    void insert(uint32_t id, PrioType prio)
+    {
+        if (buckets.contains(id)) {
+            throw std::invalid_argument("DialQueue insert: Element already in queue");
+        }
+        check_prio(prio);
+        push(id, prio);
+        ++size_;
+    }
+
+    void update_prio(uint32_t id, PrioType new_prio)
+    {
+        if (!buckets.contains(id)) {
+            throw std::out_of_range("DialQueue update_prio: Element not in queue");
+        }
+        check_prio(new_prio);
+        buckets.remove(id);
+        push(id, new_prio);
+    }
+
+    void insert_or_update(uint32_t id, PrioType prio)
+    {
+        if (buckets.contains(id)) {
+            check_prio(prio);
+            buckets.remove(id);
+            push(id, prio);
+        } else {
+            insert(id, prio);
+        }
+    }
+
+    uint32_t extract_min(PrioType& prio)
+    {
+        if (size_ == 0) {
+            throw std::out_of_range("DialQueue extract_min: Queue already empty");
+        }
+        while (buckets[static_cast<std::size_t>(last) & mask].empty()) {
+            ++last;
+        }
+        --size_;
+        prio = last;
+        return buckets.pop(static_cast<std::size_t>(last) & mask);
+    }
+
+    uint32_t extract_min()
+    {
+        PrioType prio;
+        return extract_min(prio);
+    }
+
+    bool contains(uint32_t id) const {
+        return buckets.contains(id);
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    // Empties the queue (and allows priorities below the last extracted one again).
+    void clear()
+    {
+        buckets.clear();
+        size_ = 0;
+        last = 0;
+    }
+};
+
+}
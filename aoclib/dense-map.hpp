@@ -0,0 +1,452 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <string>
+#include <vector>
+#include <variant>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include "flat-hash.hpp"
+
+namespace aocutil
+{
+/*
+    Direct-address tables for small, dense integer keys (page numbers, IDs, chars...): The key range [key_min, key_max]
+    is fixed at construction, the value of key k lives at index k - key_min of a flat array, and an occupancy bitset
+    records which keys are actually in the map. Lookups are a range check, a bit test and an array access (no hashing,
+    no probing); iteration only visits the occupied keys (in ascending order) by scanning the bitset a word at a time.
+    Keys outside of the range are never contained (find/contains/erase), but inserting them throws std::out_of_range.
+    cf. https://en.wikipedia.org/wiki/Direct-address_table (last retrieved 2024-12-20)
+*/
+
+namespace dense_map_impl
+{
+// Occupancy bitset over the indices [0, size).
+class Bitset
+{
+    std::vector<uint64_t> words;
+
+public:
+    Bitset() = default;
+    explicit Bitset(std::size_t size) : words((size + 63) / 64, 0) {}
+
+    bool test(std::size_t idx) const {
+        return (words[idx / 64] >> (idx % 64)) & 1;
+    }
+    // Returns whether the bit changed.
+    bool set(std::size_t idx)
+    {
+        const uint64_t mask = uint64_t{1} << (idx % 64);
+        const bool was_set = words[idx / 64] & mask;
+        words[idx / 64] |= mask;
+        return !was_set;
+    }
+    bool reset(std::size_t idx)
+    {
+        const uint64_t mask = uint64_t{1} << (idx % 64);
+        const bool was_set = words[idx / 64] & mask;
+        words[idx / 64] &= ~mask;
+        return was_set;
+    }
+    void clear() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+    // Index of the first set bit >= idx, or end if there is none.
+    std::size_t next_set(std::size_t idx, std::size_t end) const
+    {
+        std::size_t word_idx = idx / 64;
+        if (word_idx >= words.size()) {
+            return end;
+        }
+        uint64_t word = words[word_idx] & (~uint64_t{0} << (idx % 64));
+        while (word == 0) {
+            if (++word_idx == words.size()) {
+                return end;
+            }
+            word = words[word_idx];
+        }
+        return std::min(end, word_idx * 64 + std::countr_zero(word));
+    }
+};
+
+template<std::integral K>
+std::size_t checked_range_size(K key_min, K key_max, const char* what)
+{
+    if (key_min > key_max) {
+        throw std::invalid_argument(std::string(what) + ": key_min > key_max");
+    }
+    return static_cast<std::size_t>(static_cast<int64_t>(key_max) - static_cast<int64_t>(key_min)) + 1;
+}
+}
+
+template<std::integral K, typename V>
+class DenseMap
+{
+    std::vector<V> values;
+    dense_map_impl::Bitset occupied;
+    V fill_ {}; // Value of the unoccupied slots (and of the keys operator[] inserts).
+    K key_min_ {}, key_max_ {};
+    std::size_t size_ = 0;
+
+    std::size_t index_of(K key) const {
+        return static_cast<std::size_t>(static_cast<int64_t>(key) - static_cast<int64_t>(key_min_));
+    }
+    K key_of(std::size_t idx) const {
+        return static_cast<K>(static_cast<int64_t>(key_min_) + static_cast<int64_t>(idx));
+    }
+
+    template<typename Map, typename Ref>
+    class Iterator
+    {
+        friend class DenseMap;
+        Map* map = nullptr;
+        std::size_t idx = 0;
+
+        Iterator(Map* m, std::size_t i) : map{m}, idx{i} {}
+
+    public:
+        using value_type = std::pair<K, Ref>;
+        using difference_type = std::ptrdiff_t;
+
+        struct ArrowProxy // it->first, it->second
+        {
+            value_type pair;
+            const value_type* operator->() const {
+                return &pair;
+            }
+        };
+
+        Iterator() = default;
+        value_type operator*() const {
+            return {map->key_of(idx), map->values[idx]};
+        }
+        ArrowProxy operator->() const {
+            return {**this};
+        }
+        Iterator& operator++()
+        {
+            idx = map->occupied.next_set(idx + 1, map->values.size());
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const Iterator& other) const {
+            return idx == other.idx;
+        }
+    };
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using iterator = Iterator<DenseMap, V&>;
+    using const_iterator = Iterator<const DenseMap, const V&>;
+
+    DenseMap() = default;
+    // Map for the keys [key_min, key_max]; every slot starts out as a copy of fill.
+    DenseMap(K key_min, K key_max, const V& fill = V{}) : fill_{fill}, key_min_{key_min}, key_max_{key_max}
+    {
+        const std::size_t range = dense_map_impl::checked_range_size(key_min, key_max, "DenseMap::DenseMap");
+        values = std::vector<V>(range, fill);
+        occupied = dense_map_impl::Bitset(range);
+    }
+
+    iterator begin() {
+        return iterator(this, occupied.next_set(0, values.size()));
+    }
+    iterator end() {
+        return iterator(this, values.size());
+    }
+    const_iterator begin() const {
+        return const_iterator(this, occupied.next_set(0, values.size()));
+    }
+    const_iterator end() const {
+        return const_iterator(this, values.size());
+    }
+
+    bool in_range(K key) const {
+        return !values.empty() && key >= key_min_ && key <= key_max_;
+    }
+    bool contains(K key) const {
+        return in_range(key) && occupied.test(index_of(key));
+    }
+    std::size_t count(K key) const {
+        return contains(key);
+    }
+
+    iterator find(K key) {
+        return contains(key) ? iterator(this, index_of(key)) : end();
+    }
+    const_iterator find(K key) const {
+        return contains(key) ? const_iterator(this, index_of(key)) : end();
+    }
+
+    // Stores V(args...) for key if key is not contained yet.
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K key, Args&&... args)
+    {
+        if (!in_range(key)) {
+            throw std::out_of_range("DenseMap try_emplace: Key out of range");
+        }
+        const std::size_t idx = index_of(key);
+        const bool inserted = occupied.set(idx);
+        if (inserted) {
+            ++size_;
+            if constexpr (sizeof...(Args) > 0) {
+                values[idx] = V(std::forward<Args>(args)...);
+            }
+        }
+        return {iterator(this, idx), inserted};
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V>& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    V& operator[](K key)
+    {
+        try_emplace(key);
+        return values[index_of(key)];
+    }
+
+    V& at(K key)
+    {
+        if (!contains(key)) {
+            throw std::out_of_range("DenseMap at: Key not found");
+        }
+        return values[index_of(key)];
+    }
+    const V& at(K key) const
+    {
+        if (!contains(key)) {
+            throw std::out_of_range("DenseMap at: Key not found");
+        }
+        return values[index_of(key)];
+    }
+
+    std::size_t erase(K key)
+    {
+        if (!in_range(key) || !occupied.reset(index_of(key))) {
+            return 0;
+        }
+        values[index_of(key)] = fill_;
+        --size_;
+        return 1;
+    }
+
+    void clear()
+    {
+        for (std::size_t idx = occupied.next_set(0, values.size()); idx < values.size(); idx = occupied.next_set(idx + 1, values.size())) {
+            values[idx] = fill_;
+        }
+        occupied.clear();
+        size_ = 0;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    K key_min() const {
+        return key_min_;
+    }
+    K key_max() const {
+        return key_max_;
+    }
+};
+
+template<std::integral K>
+class DenseSet
+{
+    dense_map_impl::Bitset occupied;
+    K key_min_ {}, key_max_ {};
+    std::size_t range_ = 0, size_ = 0;
+
+    std::size_t index_of(K key) const {
+        return static_cast<std::size_t>(static_cast<int64_t>(key) - static_cast<int64_t>(key_min_));
+    }
+
+public:
+    class const_iterator
+    {
+        friend class DenseSet;
+        const DenseSet* set = nullptr;
+        std::size_t idx = 0;
+
+        const_iterator(const DenseSet* s, std::size_t i) : set{s}, idx{i} {}
+
+    public:
+        using value_type = K;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() = default;
+        K operator*() const {
+            return static_cast<K>(static_cast<int64_t>(set->key_min_) + static_cast<int64_t>(idx));
+        }
+        const_iterator& operator++()
+        {
+            idx = set->occupied.next_set(idx + 1, set->range_);
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const const_iterator& other) const {
+            return idx == other.idx;
+        }
+    };
+    using iterator = const_iterator;
+    using key_type = K;
+
+    DenseSet() = default;
+    DenseSet(K key_min, K key_max) : key_min_{key_min}, key_max_{key_max}, range_{dense_map_impl::checked_range_size(key_min, key_max, "DenseSet::DenseSet")}
+    {
+        occupied = dense_map_impl::Bitset(range_);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, occupied.next_set(0, range_));
+    }
+    const_iterator end() const {
+        return const_iterator(this, range_);
+    }
+
+    bool in_range(K key) const {
+        return range_ > 0 && key >= key_min_ && key <= key_max_;
+    }
+    bool contains(K key) const {
+        return in_range(key) && occupied.test(index_of(key));
+    }
+    std::size_t count(K key) const {
+        return contains(key);
+    }
+
+    // Returns whether key was inserted (i.e. was not contained yet).
+    bool insert(K key)
+    {
+        if (!in_range(key)) {
+            throw std::out_of_range("DenseSet insert: Key out of range");
+        }
+        const bool inserted = occupied.set(index_of(key));
+        size_ += inserted;
+        return inserted;
+    }
+
+    std::size_t erase(K key)
+    {
+        if (!in_range(key) || !occupied.reset(index_of(key))) {
+            return 0;
+        }
+        --size_;
+        return 1;
+    }
+
+    void clear()
+    {
+        occupied.clear();
+        size_ = 0;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    K key_min() const {
+        return key_min_;
+    }
+    K key_max() const {
+        return key_max_;
+    }
+};
+
+/*
+    Either a DenseMap (if the keys are dense enough) or a FlatMap, chosen once from the keys observed up front (e.g. from
+    the parsed input). A key range of up to DENSE_MIN_RANGE slots is always stored densely (at most a few pages of memory),
+    larger ranges only if they have at most DENSE_MAX_SLOTS_PER_KEY slots per key; otherwise most of the direct-address
+    table would be empty and the (smaller) hash map has the better cache behaviour.
+    visit(fn) calls fn with the underlying map, so loops over the map are compiled once per map type and do not dispatch
+    on every access.
+*/
+template<std::integral K, typename V>
+class AdaptiveMap
+{
+    std::variant<DenseMap<K, V>, FlatMap<K, V>> map;
+
+public:
+    static constexpr std::size_t DENSE_MIN_RANGE = 4096;
+    static constexpr std::size_t DENSE_MAX_SLOTS_PER_KEY = 4;
+
+    // Dense for the keys [key_min, key_max] if num_keys keys in that range are dense enough, sparse otherwise.
+    AdaptiveMap(K key_min, K key_max, std::size_t num_keys)
+    {
+        const std::size_t range = dense_map_impl::checked_range_size(key_min, key_max, "AdaptiveMap::AdaptiveMap");
+        if (range <= DENSE_MIN_RANGE || range / DENSE_MAX_SLOTS_PER_KEY <= num_keys) {
+            map.template emplace<DenseMap<K, V>>(key_min, key_max);
+        } else {
+            map.template emplace<FlatMap<K, V>>().reserve(num_keys);
+        }
+    }
+
+    // Map for the range of the (observed) keys; duplicates are fine.
+    static AdaptiveMap for_keys(std::span<const K> keys)
+    {
+        if (keys.empty()) {
+            return AdaptiveMap(K{}, K{}, 0);
+        }
+        const auto [min_it, max_it] = std::minmax_element(keys.begin(), keys.end());
+        return AdaptiveMap(*min_it, *max_it, keys.size());
+    }
+
+    bool is_dense() const {
+        return std::holds_alternative<DenseMap<K, V>>(map);
+    }
+
+    template<typename Fn>
+    decltype(auto) visit(Fn&& fn) {
+        return std::visit(std::forward<Fn>(fn), map);
+    }
+    template<typename Fn>
+    decltype(auto) visit(Fn&& fn) const {
+        return std::visit(std::forward<Fn>(fn), map);
+    }
+
+    // Single accesses (dispatch on every call; prefer visit in loops).
+    bool contains(K key) const {
+        return visit([key](const auto& m) { return m.contains(key); });
+    }
+    V& operator[](K key) {
+        return visit([key](auto& m) -> V& { return m[key]; });
+    }
+    V& at(K key) {
+        return visit([key](auto& m) -> V& { return m.at(key); });
+    }
+    const V& at(K key) const {
+        return visit([key](const auto& m) -> const V& { return m.at(key); });
+    }
+    std::size_t erase(K key) {
+        return visit([key](auto& m) { return m.erase(key); });
+    }
+    std::size_t size() const {
+        return visit([](const auto& m) { return m.size(); });
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+}
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include "flat-hash.hpp"
+
+/*
+    Eviction policies for LRUCache (cf. lru-cache.hpp). The cache stores its elements in a pool of slots and maps every
+    key to its slot index; a policy only sees slot indices (and the keys of elements entering or leaving the cache), and
+    keeps its own per-slot metadata in arrays indexed by slot, so all policies share the cache's node pool:
+    - LRU: Evicts the least recently used element. One intrusive doubly linked list; a hit moves the element to its front.
+    - Clock: Approximates LRU with one reference bit per slot, which a hit sets (no relinking, so hits don't write to other
+      slots' metadata); the clock hand clears set bits and evicts the first element whose bit is clear. New elements start
+      with a clear bit, so elements of a one-shot scan are evicted at the next turn of the hand.
+      cf. https://en.wikipedia.org/wiki/Page_replacement_algorithm#Clock (last retrieved 2024-12-20)
+    - TwoQ: New elements enter a FIFO queue (A1in, a quarter of the capacity); only elements which are requested again
+      after they left it (their keys are remembered in the "ghost" queue A1out) are promoted into the main LRU list (Am).
+      One-shot scans therefore only ever displace A1in.
+      cf. Johnson, Shasha: "2Q: A Low Overhead High Performance Buffer Management Replacement Algorithm" (1994)
+    - ARC: Adaptive replacement cache: Elements seen once (T1) and more than once (T2) are kept in separate LRU lists,
+      and the keys of elements evicted from them in two ghost lists (B1, B2). Ghost hits shift the target size of T1
+      towards whichever list would have hit. No tuning parameters, but the most bookkeeping per miss.
+      cf. Megiddo, Modha: "ARC: A Self-Tuning, Low Overhead Replacement Cache" (2003)
+    Policy interface (Idx: slot index):
+        on_hit(idx)              The element in slot idx was requested.
+        on_miss(key)             key was requested but is not cached; called before victim/on_insert of the same miss.
+        victim()                 Slot of the element to evict next (only called if the cache is full).
+        on_evict(idx, key)       The element with key in slot idx is evicted.
+        on_insert(idx, key)      A new element with key was stored in slot idx.
+        relocate(from, to)       The element in slot from was moved into the unused slot to.
+        resize(capacity)         New number of slots (all used slots are below it), clear(), for_each(fn) (cache order).
+*/
+
+namespace aocutil
+{
+enum class EvictionPolicy {LRU, Clock, TwoQ, ARC};
+
+namespace eviction_impl
+{
+using Idx = uint32_t;
+constexpr Idx IDX_NULL = std::numeric_limits<Idx>::max();
+
+// Link arrays shared by all IndexLists of a policy (every slot is in at most one of them).
+struct Links
+{
+    std::vector<Idx> prev, next;
+
+    void resize(std::size_t n)
+    {
+        prev.resize(n, IDX_NULL);
+        next.resize(n, IDX_NULL);
+    }
+};
+
+// Intrusive doubly linked list of slot indices (front: most recently inserted/used).
+class IndexList
+{
+    Idx head = IDX_NULL, tail = IDX_NULL;
+    std::size_t size_ = 0;
+
+public:
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    Idx front() const {
+        return head;
+    }
+    Idx back() const {
+        return tail;
+    }
+    void clear()
+    {
+        head = tail = IDX_NULL;
+        size_ = 0;
+    }
+
+    void push_front(Links& links, Idx idx)
+    {
+        links.prev[idx] = IDX_NULL;
+        links.next[idx] = head;
+        if (head != IDX_NULL) {
+            links.prev[head] = idx;
+        }
+        head = idx;
+        if (tail == IDX_NULL) {
+            tail = idx;
+        }
+        ++size_;
+    }
+
+    void remove(Links& links, Idx idx)
+    {
+        const Idx prev_idx = links.prev[idx], next_idx = links.next[idx];
+        if (prev_idx != IDX_NULL) {
+            links.next[prev_idx] = next_idx;
+        } else {
+            assert(head == idx);
+            head = next_idx;
+        }
+        if (next_idx != IDX_NULL) {
+            links.prev[next_idx] = prev_idx;
+        } else {
+            assert(tail == idx);
+            tail = prev_idx;
+        }
+        --size_;
+    }
+
+    void move_to_front(Links& links, Idx idx)
+    {
+        if (idx != head) {
+            remove(links, idx);
+            push_front(links, idx);
+        }
+    }
+
+    // The element in slot from moves into slot to (which is in no list).
+    void relocate(Links& links, Idx from, Idx to)
+    {
+        const Idx prev_idx = links.prev[from], next_idx = links.next[from];
+        links.prev[to] = prev_idx;
+        links.next[to] = next_idx;
+        (prev_idx != IDX_NULL ? links.next[prev_idx] : head) = to;
+        (next_idx != IDX_NULL ? links.prev[next_idx] : tail) = to;
+    }
+
+    // Position of idx (0: front); walks from both ends at once, so it takes at most size / 2 steps.
+    std::size_t rank(const Links& links, Idx idx) const
+    {
+        std::size_t steps = 0;
+        Idx from_head = head, from_tail = tail;
+        while (from_head != idx && from_tail != idx) {
+            from_head = links.next[from_head];
+            from_tail = links.prev[from_tail];
+            ++steps;
+        }
+        return from_head == idx ? steps : size_ - 1 - steps;
+    }
+
+    template<typename Fn>
+    void for_each(const Links& links, Fn fn) const
+    {
+        for (Idx idx = head; idx != IDX_NULL; idx = links.next[idx]) {
+            fn(idx);
+        }
+    }
+};
+
+// NumLists lists of "ghost" keys (keys of evicted elements, without values), each ordered like an IndexList.
+template<typename Key, typename Hash, int NumLists>
+class Ghosts
+{
+    FlatMap<Key, Idx, Hash> index; // Key -> ghost id.
+    std::vector<Key> keys; // By ghost id.
+    std::vector<uint8_t> list_of; // By ghost id.
+    std::vector<Idx> free_ids;
+    Links links;
+    std::array<IndexList, NumLists> lists;
+
+    void remove_id(Idx id)
+    {
+        lists[list_of[id]].remove(links, id);
+        free_ids.push_back(id);
+    }
+
+public:
+    std::size_t size(int list) const {
+        return lists[list].size();
+    }
+
+    // Number of the list which contains key, or -1.
+    int find(const Key& key) const
+    {
+        const auto it = index.find(key);
+        return it == index.end() ? -1 : list_of[it->second];
+    }
+
+    // Removes key; returns the number of the list which contained it, or -1.
+    int erase(const Key& key)
+    {
+        const auto it = index.find(key);
+        if (it == index.end()) {
+            return -1;
+        }
+        const Idx id = it->second;
+        index.erase(it);
+        remove_id(id);
+        return list_of[id];
+    }
+
+    void push_front(int list, const Key& key)
+    {
+        Idx id;
+        if (free_ids.empty()) {
+            id = static_cast<Idx>(keys.size());
+            keys.push_back(key);
+            list_of.push_back(0);
+            links.resize(keys.size());
+        } else {
+            id = free_ids.back();
+            free_ids.pop_back();
+            keys[id] = key;
+        }
+        [[maybe_unused]] const bool inserted = index.try_emplace(key, id).second;
+        assert(inserted);
+        list_of[id] = static_cast<uint8_t>(list);
+        lists[list].push_front(links, id);
+    }
+
+    // Forgets the oldest key of list.
+    void pop_back(int list)
+    {
+        const Idx id = lists[list].back();
+        assert(id != IDX_NULL);
+        index.erase(keys[id]);
+        remove_id(id);
+    }
+
+    void clear()
+    {
+        index.clear();
+        keys.clear();
+        list_of.clear();
+        free_ids.clear();
+        links.resize(0);
+        for (IndexList& list : lists) {
+            list.clear();
+        }
+    }
+};
+
+template<EvictionPolicy policy, typename Key, typename Hash>
+class Policy;
+
+template<typename Key, typename Hash>
+class Policy<EvictionPolicy::LRU, Key, Hash>
+{
+    Links links;
+    IndexList list;
+
+public:
+    explicit Policy(std::size_t capacity) {
+        links.resize(capacity);
+    }
+
+    void on_hit(Idx idx) {
+        list.move_to_front(links, idx);
+    }
+    void on_miss(const Key&) {}
+    Idx victim() const {
+        return list.back();
+    }
+    void on_evict(Idx idx, const Key&) {
+        list.remove(links, idx);
+    }
+    void on_insert(Idx idx, const Key&) {
+        list.push_front(links, idx);
+    }
+    void relocate(Idx from, Idx to) {
+        list.relocate(links, from, to);
+    }
+    void resize(std::size_t capacity) {
+        links.resize(capacity);
+    }
+    void clear() {
+        list.clear();
+    }
+    template<typename Fn>
+    void for_each(Fn fn) const {
+        list.for_each(links, fn);
+    }
+
+    // Number of elements used more recently than the one in slot idx.
+    std::size_t recency_rank(Idx idx) const {
+        return list.rank(links, idx);
+    }
+};
+
+template<typename Key, typename Hash>
+class Policy<EvictionPolicy::Clock, Key, Hash>
+{
+    enum SlotState : uint8_t {FREE, RESIDENT, REFERENCED};
+    std::vector<uint8_t> state;
+    Idx hand = 0;
+
+    void advance() {
+        hand = hand + 1 == state.size() ? 0 : hand + 1;
+    }
+
+public:
+    explicit Policy(std::size_t capacity) : state(capacity, FREE) {}
+
+    void on_hit(Idx idx) {
+        state[idx] = REFERENCED;
+    }
+    void on_miss(const Key&) {}
+    Idx victim()
+    {
+        while (state[hand] != RESIDENT) { // Terminates: After one turn, all bits are clear.
+            if (state[hand] == REFERENCED) {
+                state[hand] = RESIDENT;
+            }
+            advance();
+        }
+        const Idx idx = hand;
+        advance();
+        return idx;
+    }
+    void on_evict(Idx idx, const Key&) {
+        state[idx] = FREE;
+    }
+    void on_insert(Idx idx, const Key&) {
+        state[idx] = RESIDENT;
+    }
+    void relocate(Idx from, Idx to)
+    {
+        state[to] = state[from];
+        state[from] = FREE;
+    }
+    void resize(std::size_t capacity)
+    {
+        state.resize(capacity, FREE);
+        hand = hand < capacity ? hand : 0;
+    }
+    void clear()
+    {
+        std::fill(state.begin(), state.end(), FREE);
+        hand = 0;
+    }
+    template<typename Fn>
+    void for_each(Fn fn) const // In the order in which the hand reaches them.
+    {
+        for (std::size_t i = 0; i < state.size(); ++i) {
+            const Idx idx = static_cast<Idx>((hand + i) % state.size());
+            if (state[idx] != FREE) {
+                fn(idx);
+            }
+        }
+    }
+};
+
+template<typename Key, typename Hash>
+class Policy<EvictionPolicy::TwoQ, Key, Hash>
+{
+    static constexpr std::size_t KIN_DIVISOR = 4, KOUT_DIVISOR = 2; // Sizes of A1in and A1out as recommended by the paper.
+
+    Links links;
+    IndexList a1in, am;
+    std::vector<uint8_t> in_am;
+    Ghosts<Key, Hash, 1> a1out;
+    std::size_t kin = 1, kout = 1;
+
+public:
+    explicit Policy(std::size_t capacity) {
+        resize(capacity);
+    }
+
+    void on_hit(Idx idx)
+    {
+        if (in_am[idx]) {
+            am.move_to_front(links, idx);
+        } // Hits in A1in don't count: They are usually correlated references shortly after the first one.
+    }
+    void on_miss(const Key&) {}
+    Idx victim() const {
+        return a1in.size() > kin || am.empty() ? a1in.back() : am.back();
+    }
+    void on_evict(Idx idx, const Key& key)
+    {
+        if (in_am[idx]) {
+            am.remove(links, idx);
+            return;
+        }
+        a1in.remove(links, idx);
+        a1out.push_front(0, key);
+        if (a1out.size(0) > kout) {
+            a1out.pop_back(0);
+        }
+    }
+    void on_insert(Idx idx, const Key& key)
+    {
+        in_am[idx] = a1out.erase(key) != -1;
+        (in_am[idx] ? am : a1in).push_front(links, idx);
+    }
+    void relocate(Idx from, Idx to)
+    {
+        (in_am[from] ? am : a1in).relocate(links, from, to);
+        in_am[to] = in_am[from];
+    }
+    void resize(std::size_t capacity)
+    {
+        links.resize(capacity);
+        in_am.resize(capacity, 0);
+        kin = std::max<std::size_t>(1, capacity / KIN_DIVISOR);
+        kout = std::max<std::size_t>(1, capacity / KOUT_DIVISOR);
+        while (a1out.size(0) > kout) {
+            a1out.pop_back(0);
+        }
+    }
+    void clear()
+    {
+        a1in.clear();
+        am.clear();
+        a1out.clear();
+    }
+    template<typename Fn>
+    void for_each(Fn fn) const
+    {
+        am.for_each(links, fn);
+        a1in.for_each(links, fn);
+    }
+};
+
+template<typename Key, typename Hash>
+class Policy<EvictionPolicy::ARC, Key, Hash>
+{
+    static constexpr int B1 = 0, B2 = 1;
+
+    Links links;
+    IndexList t1, t2;
+    std::vector<uint8_t> in_t2;
+    Ghosts<Key, Hash, 2> ghosts;
+    std::size_t capacity_ = 0;
+    std::size_t p = 0; // Target size of T1.
+    int incoming_ghost = -1; // Ghost list of the key of the current miss.
+    bool ghost_victim = true; // Remember the key of the next victim in a ghost list.
+
+public:
+    explicit Policy(std::size_t capacity) {
+        resize(capacity);
+    }
+
+    void on_hit(Idx idx)
+    {
+        if (in_t2[idx]) {
+            t2.move_to_front(links, idx);
+        } else {
+            t1.remove(links, idx);
+            t2.push_front(links, idx);
+            in_t2[idx] = 1;
+        }
+    }
+
+    // Cases II to IV of the paper's ARC(c) (case I are hits); the REPLACE part is split between victim and on_evict.
+    void on_miss(const Key& key)
+    {
+        incoming_ghost = ghosts.find(key);
+        ghost_victim = true;
+        const std::size_t b1 = ghosts.size(B1), b2 = ghosts.size(B2);
+        if (incoming_ghost == B1) {
+            p = std::min(capacity_, p + std::max<std::size_t>(b2 / b1, 1));
+        } else if (incoming_ghost == B2) {
+            p -= std::min(p, std::max<std::size_t>(b1 / b2, 1));
+        } else if (t1.size() + b1 == capacity_) {
+            if (t1.size() < capacity_) {
+                ghosts.pop_back(B1);
+            } else {
+                ghost_victim = false; // B1 is empty and T1 is full: The least recently used element of T1 is evicted without a trace.
+            }
+        } else if (t1.size() + t2.size() + b1 + b2 == 2 * capacity_) {
+            ghosts.pop_back(B2);
+        }
+    }
+
+    Idx victim() const
+    {
+        const bool from_t1 = !t1.empty() && (!ghost_victim || t2.empty() || t1.size() > p || (incoming_ghost == B2 && t1.size() == p));
+        return from_t1 ? t1.back() : t2.back();
+    }
+
+    void on_evict(Idx idx, const Key& key)
+    {
+        (in_t2[idx] ? t2 : t1).remove(links, idx);
+        if (ghost_victim) {
+            ghosts.push_front(in_t2[idx] ? B2 : B1, key);
+        }
+        ghost_victim = true;
+    }
+
+    void on_insert(Idx idx, const Key& key)
+    {
+        in_t2[idx] = ghosts.erase(key) != -1; // Ghost hits go straight to T2.
+        (in_t2[idx] ? t2 : t1).push_front(links, idx);
+        incoming_ghost = -1;
+    }
+
+    void relocate(Idx from, Idx to)
+    {
+        (in_t2[from] ? t2 : t1).relocate(links, from, to);
+        in_t2[to] = in_t2[from];
+    }
+
+    void resize(std::size_t capacity) // The ghost lists are forgotten (they are sized for the old capacity).
+    {
+        links.resize(capacity);
+        in_t2.resize(capacity, 0);
+        capacity_ = capacity;
+        p = std::min(p, capacity);
+        ghosts.clear();
+    }
+
+    void clear()
+    {
+        t1.clear();
+        t2.clear();
+        ghosts.clear();
+        p = 0;
+    }
+
+    template<typename Fn>
+    void for_each(Fn fn) const
+    {
+        t2.for_each(links, fn);
+        t1.for_each(links, fn);
+    }
+};
+}
+
+}
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <utility>
+#include <initializer_list>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "hash.hpp"
+
+namespace aocutil
+{
+/*
+    Open addressing hash map/set (FlatMap/FlatSet) with robin hood probing, as a replacement for the node based
+    std::unordered_map/std::unordered_set:
+    - All entries live in one contiguous std::vector (iteration is a linear scan), the bucket array only holds
+      {probe distance + fingerprint, entry index} pairs (8 bytes per bucket).
+    - Lookups compare the probe distance and 8-bit fingerprint first and stop as soon as they reach a bucket that is
+      "richer" (i.e. closer to its ideal bucket) than the key would be; cf. https://programming.guide/robin-hood-hashing.html
+      (last retrieved 2024-12-20)
+    - Erase is tombstone-free: The following buckets are shifted back ("backward shift deletion"), and the last entry
+      is moved into the erased entry's slot.
+    - find/contains/count/erase accept any key type K if both Hash and KeyEqual are transparent (heterogeneous lookup,
+      e.g. std::string_view for std::string keys with FastHash).
+    The bucket index is taken from the high bits of the hash, so Hash must mix well (FastHash does, std::hash<int> does not).
+    Pointers, references and iterators to entries are invalidated by any insertion and erase (like for std::vector).
+    Layout similar to https://github.com/martinus/unordered_dense (last retrieved 2024-12-20).
+*/
+
+namespace flat_hash_impl
+{
+template<typename Key, typename ValueType, typename KeyOf, typename Hash, typename KeyEqual>
+class Table
+{
+protected:
+    struct Bucket
+    {
+        uint32_t dist_fp; // (Probe distance + 1) << 8 | fingerprint; 0 if empty.
+        uint32_t entry_idx;
+    };
+    static constexpr uint32_t DIST_INC = 1u << 8;
+    static constexpr uint32_t FP_MASK = DIST_INC - 1;
+    static constexpr double MAX_LOAD_FACTOR = 0.8;
+    static constexpr std::size_t MIN_BUCKETS = 8;
+
+    std::vector<ValueType> entries;
+    std::vector<Bucket> buckets;
+    int shift = 64; // Bucket index = hash >> shift.
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual key_equal;
+
+    template<typename K>
+    static constexpr bool is_transparent = requires { typename Hash::is_transparent; typename KeyEqual::is_transparent; };
+
+    std::size_t next(std::size_t bucket_idx) const {
+        return (bucket_idx + 1) & (buckets.size() - 1);
+    }
+    uint64_t hash_of(const auto& key) const {
+        return static_cast<uint64_t>(hasher(key));
+    }
+    static uint32_t dist_fp_of(uint64_t hash) {
+        return DIST_INC | static_cast<uint32_t>(hash & FP_MASK);
+    }
+    std::size_t bucket_of(uint64_t hash) const {
+        return shift >= 64 ? 0 : static_cast<std::size_t>(hash >> shift);
+    }
+
+    // Inserts bucket at bucket_idx, shifting the following (richer) buckets back as robin hood hashing requires.
+    void place(Bucket bucket, std::size_t bucket_idx)
+    {
+        while (buckets[bucket_idx].dist_fp != 0) {
+            std::swap(bucket, buckets[bucket_idx]);
+            bucket.dist_fp += DIST_INC;
+            bucket_idx = next(bucket_idx);
+        }
+        buckets[bucket_idx] = bucket;
+    }
+
+    void insert_bucket_for(uint32_t entry_idx)
+    {
+        const uint64_t h = hash_of(KeyOf::get(entries[entry_idx]));
+        uint32_t dist_fp = dist_fp_of(h);
+        std::size_t bucket_idx = bucket_of(h);
+        while (dist_fp <= buckets[bucket_idx].dist_fp) {
+            dist_fp += DIST_INC;
+            bucket_idx = next(bucket_idx);
+        }
+        place(Bucket{dist_fp, entry_idx}, bucket_idx);
+    }
+
+    void rehash(std::size_t num_buckets)
+    {
+        assert(std::has_single_bit(num_buckets));
+        buckets.assign(num_buckets, Bucket{0, 0});
+        shift = 64 - std::countr_zero(num_buckets);
+        for (uint32_t i = 0; i < entries.size(); ++i) {
+            insert_bucket_for(i);
+        }
+    }
+
+    void grow_if_needed(std::size_t new_size)
+    {
+        if (new_size > buckets.size() * MAX_LOAD_FACTOR) {
+            rehash(std::max(MIN_BUCKETS, buckets.size() * 2));
+        }
+    }
+
+    // Bucket index of key, or buckets.size() if the key is not contained.
+    template<typename K>
+    std::size_t find_bucket(const K& key) const
+    {
+        if (entries.empty()) {
+            return buckets.size();
+        }
+        const uint64_t h = hash_of(key);
+        uint32_t dist_fp = dist_fp_of(h);
+        std::size_t bucket_idx = bucket_of(h);
+        while (true) {
+            const Bucket& bucket = buckets[bucket_idx];
+            if (bucket.dist_fp == dist_fp && key_equal(KeyOf::get(entries[bucket.entry_idx]), key)) {
+                return bucket_idx;
+            }
+            if (bucket.dist_fp < dist_fp) {
+                return buckets.size();
+            }
+            dist_fp += DIST_INC;
+            bucket_idx = next(bucket_idx);
+        }
+    }
+
+    /*
+        Single probe sequence for lookup and insertion: Returns the index of the entry of key and false if the key is
+        already contained, or constructs a new entry with make_entry() and returns its index and true.
+    */
+    template<typename K, typename MakeEntry>
+    std::pair<std::size_t, bool> find_or_insert(const K& key, MakeEntry make_entry)
+    {
+        grow_if_needed(entries.size() + 1);
+        const uint64_t h = hash_of(key);
+        uint32_t dist_fp = dist_fp_of(h);
+        std::size_t bucket_idx = bucket_of(h);
+        while (true) {
+            const Bucket& bucket = buckets[bucket_idx];
+            if (bucket.dist_fp == dist_fp && key_equal(KeyOf::get(entries[bucket.entry_idx]), key)) {
+                return {bucket.entry_idx, false};
+            }
+            if (bucket.dist_fp < dist_fp) {
+                break;
+            }
+            dist_fp += DIST_INC;
+            bucket_idx = next(bucket_idx);
+        }
+        const uint32_t entry_idx = entries.size();
+        entries.push_back(make_entry());
+        place(Bucket{dist_fp, entry_idx}, bucket_idx);
+        return {entry_idx, true};
+    }
+
+    void erase_bucket(std::size_t bucket_idx)
+    {
+        const uint32_t entry_idx = buckets[bucket_idx].entry_idx;
+
+        // Backward shift deletion: Move the following buckets one step closer to their ideal bucket, until we reach an empty bucket or one which already is in its ideal bucket.
+        for (std::size_t next_idx = next(bucket_idx); buckets[next_idx].dist_fp >= 2 * DIST_INC; next_idx = next(next_idx)) {
+            buckets[bucket_idx] = buckets[next_idx];
+            buckets[bucket_idx].dist_fp -= DIST_INC;
+            bucket_idx = next_idx;
+        }
+        buckets[bucket_idx] = Bucket{0, 0};
+
+        // Keep the entries contiguous by moving the last entry into the hole.
+        const uint32_t last_idx = entries.size() - 1;
+        if (entry_idx != last_idx) {
+            std::size_t last_bucket = bucket_of(hash_of(KeyOf::get(entries[last_idx])));
+            while (buckets[last_bucket].entry_idx != last_idx || buckets[last_bucket].dist_fp == 0) {
+                last_bucket = next(last_bucket);
+            }
+            buckets[last_bucket].entry_idx = entry_idx;
+            entries[entry_idx] = std::move(entries[last_idx]);
+        }
+        entries.pop_back();
+    }
+
+public:
+    using key_type = Key;
+    using value_type = ValueType;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<ValueType>::iterator;
+    using const_iterator = typename std::vector<ValueType>::const_iterator;
+
+    Table() = default;
+
+    iterator begin() {
+        return entries.begin();
+    }
+    iterator end() {
+        return entries.end();
+    }
+    const_iterator begin() const {
+        return entries.begin();
+    }
+    const_iterator end() const {
+        return entries.end();
+    }
+    const_iterator cbegin() const {
+        return entries.cbegin();
+    }
+    const_iterator cend() const {
+        return entries.cend();
+    }
+
+    std::size_t size() const {
+        return entries.size();
+    }
+    bool empty() const {
+        return entries.empty();
+    }
+    std::size_t bucket_count() const {
+        return buckets.size();
+    }
+
+    void clear()
+    {
+        entries.clear();
+        std::fill(buckets.begin(), buckets.end(), Bucket{0, 0});
+    }
+
+    void reserve(std::size_t n)
+    {
+        entries.reserve(n);
+        std::size_t num_buckets = std::max(MIN_BUCKETS, buckets.size());
+        while (n > num_buckets * MAX_LOAD_FACTOR) {
+            num_buckets *= 2;
+        }
+        if (num_buckets != buckets.size()) {
+            rehash(num_buckets);
+        }
+    }
+
+    iterator find(const Key& key)
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        return bucket_idx == buckets.size() ? end() : begin() + buckets[bucket_idx].entry_idx;
+    }
+    const_iterator find(const Key& key) const
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        return bucket_idx == buckets.size() ? end() : begin() + buckets[bucket_idx].entry_idx;
+    }
+    template<typename K> requires is_transparent<K>
+    iterator find(const K& key)
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        return bucket_idx == buckets.size() ? end() : begin() + buckets[bucket_idx].entry_idx;
+    }
+    template<typename K> requires is_transparent<K>
+    const_iterator find(const K& key) const
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        return bucket_idx == buckets.size() ? end() : begin() + buckets[bucket_idx].entry_idx;
+    }
+
+    bool contains(const Key& key) const {
+        return find_bucket(key) != buckets.size();
+    }
+    template<typename K> requires is_transparent<K>
+    bool contains(const K& key) const {
+        return find_bucket(key) != buckets.size();
+    }
+    std::size_t count(const Key& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    std::size_t erase(const Key& key)
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        if (bucket_idx == buckets.size()) {
+            return 0;
+        }
+        erase_bucket(bucket_idx);
+        return 1;
+    }
+    template<typename K> requires is_transparent<K>
+    std::size_t erase(const K& key)
+    {
+        const std::size_t bucket_idx = find_bucket(key);
+        if (bucket_idx == buckets.size()) {
+            return 0;
+        }
+        erase_bucket(bucket_idx);
+        return 1;
+    }
+
+    // Returns an iterator to the same position, which then holds the entry that was last before (so erasing while iterating works like for std::vector with "it = erase(it)").
+    iterator erase(const_iterator it)
+    {
+        const std::size_t pos = it - cbegin();
+        erase_bucket(find_bucket(KeyOf::get(*it)));
+        return begin() + pos;
+    }
+
+    bool operator==(const Table& other) const
+    {
+        if (size() != other.size()) {
+            return false;
+        }
+        for (const ValueType& entry : entries) {
+            const auto it = other.find(KeyOf::get(entry));
+            if (it == other.end() || !(*it == entry)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct MapKeyOf
+{
+    template<typename Pair>
+    static const auto& get(const Pair& entry) {
+        return entry.first;
+    }
+};
+
+struct SetKeyOf
+{
+    template<typename Key>
+    static const Key& get(const Key& entry) {
+        return entry;
+    }
+};
+}
+
+template<typename Key, typename Val, typename Hash = FastHash<Key>, typename KeyEqual = std::equal_to<>>
+class FlatMap : public flat_hash_impl::Table<Key, std::pair<Key, Val>, flat_hash_impl::MapKeyOf, Hash, KeyEqual>
+{
+    using Base = flat_hash_impl::Table<Key, std::pair<Key, Val>, flat_hash_impl::MapKeyOf, Hash, KeyEqual>;
+
+public:
+    using mapped_type = Val;
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+
+    FlatMap() = default;
+    FlatMap(std::initializer_list<std::pair<Key, Val>> init)
+    {
+        this->reserve(init.size());
+        for (const auto& [key, val] : init) {
+            try_emplace(key, val);
+        }
+    }
+
+    // Constructs the value from args only if key is not contained yet (single probe sequence either way).
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+    {
+        const auto [idx, inserted] = this->find_or_insert(key, [&]() {
+            return std::pair<Key, Val>(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+        return {this->begin() + idx, inserted};
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<Key, Val>& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    template<typename V>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, V&& val)
+    {
+        auto result = try_emplace(key, std::forward<V>(val));
+        if (!result.second) {
+            result.first->second = std::forward<V>(val);
+        }
+        return result;
+    }
+
+    Val& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    Val& at(const Key& key)
+    {
+        const auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("FlatMap at: Key not found");
+        }
+        return it->second;
+    }
+    const Val& at(const Key& key) const
+    {
+        const auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("FlatMap at: Key not found");
+        }
+        return it->second;
+    }
+};
+
+template<typename Key, typename Hash = FastHash<Key>, typename KeyEqual = std::equal_to<>>
+class FlatSet : public flat_hash_impl::Table<Key, Key, flat_hash_impl::SetKeyOf, Hash, KeyEqual>
+{
+    using Base = flat_hash_impl::Table<Key, Key, flat_hash_impl::SetKeyOf, Hash, KeyEqual>;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+
+    FlatSet() = default;
+    FlatSet(std::initializer_list<Key> init)
+    {
+        this->reserve(init.size());
+        for (const Key& key : init) {
+            insert(key);
+        }
+    }
+
+    std::pair<iterator, bool> insert(const Key& key)
+    {
+        const auto [idx, inserted] = this->find_or_insert(key, [&key]() { return key; });
+        return {this->begin() + idx, inserted};
+    }
+};
+
+}
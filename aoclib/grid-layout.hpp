@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cassert>
+#include <string_view>
+#include "grid.hpp"
+#include "vec.hpp"
+#include "parallel.hpp"
+
+/*
+    Re-laid-out copies of a Grid which turn strided accesses (columns, diagonals) into contiguous ones: transposed()
+    makes columns rows, and GridDiagonals stores every diagonal (or anti-diagonal) contiguously. Afterwards, scanning a
+    grid in any of the 8 directions is a linear scan over contiguous memory (e.g. std::string_view::find for char grids).
+    Both copies are made tile by tile (GRID_LAYOUT_TILE x GRID_LAYOUT_TILE cells), so the source rows and destination
+    rows/diagonals touched by a tile stay in cache, instead of missing cache on every write for large grids.
+    cf. https://en.wikipedia.org/wiki/Loop_nest_optimization (last retrieved 2024-12-20)
+*/
+
+namespace aocutil
+{
+constexpr int GRID_LAYOUT_TILE = 32;
+constexpr int GRID_LAYOUT_PARALLEL_MIN_CELLS = 1 << 20; // For num_threads == 0, smaller grids are copied in the calling thread only.
+
+namespace grid_layout_impl
+{
+inline int resolve_num_threads(int num_threads, int num_cells)
+{
+    if (num_threads < 0) {
+        throw std::invalid_argument("grid_layout: num_threads less than zero.");
+    }
+    if (num_threads == 0) {
+        return num_cells >= GRID_LAYOUT_PARALLEL_MIN_CELLS ? get_num_threads_default() : 1;
+    }
+    return num_threads;
+}
+
+// Calls fn(x, y) for all cells, tile by tile; the rows of tiles are split between the threads.
+template<typename Fn>
+void foreach_tiled(int width, int height, int num_threads, Fn fn)
+{
+    const int num_tile_rows = (height + GRID_LAYOUT_TILE - 1) / GRID_LAYOUT_TILE;
+    parallel_row_bands(num_tile_rows, resolve_num_threads(num_threads, width * height), [width, height, &fn](int tile_row_begin, int tile_row_end) -> int64_t {
+        const int y_end = std::min(height, tile_row_end * GRID_LAYOUT_TILE);
+        for (int y0 = tile_row_begin * GRID_LAYOUT_TILE; y0 < y_end; y0 += GRID_LAYOUT_TILE) {
+            for (int x0 = 0; x0 < width; x0 += GRID_LAYOUT_TILE) {
+                for (int y = y0; y < std::min(y0 + GRID_LAYOUT_TILE, height); ++y) {
+                    for (int x = x0; x < std::min(x0 + GRID_LAYOUT_TILE, width); ++x) {
+                        fn(x, y);
+                    }
+                }
+            }
+        }
+        return 0;
+    });
+}
+}
+
+/*
+    Returns the transposed grid (i.e. its rows are the columns of grid). Every destination element is written by exactly
+    one tile, so the threads (num_threads 0: parallel for large grids only) never write to the same element.
+*/
+template<typename ElemType>
+Grid<ElemType> transposed(const Grid<ElemType>& grid, int num_threads = 0)
+{
+    static_assert(!std::is_same_v<ElemType, bool>, "transposed: Grid<bool> is not supported (std::vector<bool> is not thread safe for writes to different elements).");
+    Grid<ElemType> result(grid.height(), grid.width(), ElemType{});
+    // Raw pointers captured by value: Stores through a char* may alias anything, which would otherwise force reloads of the span pointers after every store.
+    const ElemType* src = grid.elems().data();
+    ElemType* dst = result.elems().data();
+    const int width = grid.width(), height = grid.height();
+    grid_layout_impl::foreach_tiled(width, height, num_threads, [src, dst, width, height](int x, int y) {
+        dst[y + x * height] = src[x + y * width];
+    });
+    return result;
+}
+
+/*
+    All diagonals of a grid, each stored contiguously in one buffer:
+    - DiagonalDir::Main: The cells with the same x - y, walked in direction (1, 1). Diagonal i has x - y == i - (height - 1).
+    - DiagonalDir::Anti: The cells with the same x + y, walked in direction (1, -1). Diagonal i has x + y == i.
+    Walking a diagonal backwards gives the opposite direction, so together with the rows and columns (transposed) all
+    8 directions are covered.
+*/
+enum class DiagonalDir {Main, Anti};
+
+template<typename ElemType>
+class GridDiagonals
+{
+    static_assert(!std::is_same_v<ElemType, bool>, "GridDiagonals: Grid<bool> is not supported.");
+
+    std::vector<ElemType> data;
+    std::vector<int> starts; // Diagonal i is [starts[i], starts[i + 1]).
+    DiagonalDir dir_;
+    int width_ = 0, height_ = 0;
+
+    // Position of the first cell of diagonal i.
+    Vec2<int> diagonal_start(int i) const
+    {
+        if (dir_ == DiagonalDir::Main) {
+            const int d = i - (height_ - 1); // x - y
+            return d >= 0 ? Vec2<int>{d, 0} : Vec2<int>{0, -d};
+        }
+        return i < height_ ? Vec2<int>{0, i} : Vec2<int>{i - (height_ - 1), height_ - 1};
+    }
+
+public:
+    GridDiagonals(const Grid<ElemType>& grid, DiagonalDir dir, int num_threads = 0) : dir_{dir}, width_{grid.width()}, height_{grid.height()}
+    {
+        const int num_diagonals = width_ > 0 && height_ > 0 ? width_ + height_ - 1 : 0;
+        starts = std::vector<int>(num_diagonals + 1, 0);
+        for (int i = 0; i < num_diagonals; ++i) {
+            const Vec2<int> start = diagonal_start(i);
+            const int length = dir_ == DiagonalDir::Main ? std::min(width_ - start.x, height_ - start.y) : std::min(width_ - start.x, start.y + 1);
+            starts[i + 1] = starts[i] + length;
+        }
+        assert(starts.back() == width_ * height_);
+
+        data = std::vector<ElemType>(width_ * height_);
+        const ElemType* src = grid.elems().data(); // Raw pointers and copies of the members for the same reason as in transposed.
+        ElemType* dst = data.data();
+        const int* diagonal_starts = starts.data();
+        const int width = width_, height = height_;
+        if (dir_ == DiagonalDir::Main) {
+            grid_layout_impl::foreach_tiled(width, height, num_threads, [src, dst, diagonal_starts, width, height](int x, int y) {
+                dst[diagonal_starts[x - y + height - 1] + std::min(x, y)] = src[x + y * width];
+            });
+        } else {
+            grid_layout_impl::foreach_tiled(width, height, num_threads, [src, dst, diagonal_starts, width, height](int x, int y) {
+                dst[diagonal_starts[x + y] + std::min(x, height - 1 - y)] = src[x + y * width];
+            });
+        }
+    }
+
+    int size() const {
+        return std::ssize(starts) - 1;
+    }
+
+    std::span<const ElemType> diagonal(int i) const
+    {
+        if (i < 0 || i >= size()) {
+            throw std::out_of_range("GridDiagonals diagonal: invalid index");
+        }
+        return std::span<const ElemType>(data.data() + starts[i], starts[i + 1] - starts[i]);
+    }
+    std::span<const ElemType> operator[](int i) const {
+        return diagonal(i);
+    }
+
+    // Grid position of the n-th cell of diagonal i.
+    Vec2<int> cell_pos(int i, int n) const
+    {
+        if (i < 0 || i >= size() || n < 0 || n >= starts[i + 1] - starts[i]) {
+            throw std::out_of_range("GridDiagonals cell_pos: invalid index");
+        }
+        return diagonal_start(i) + n * (dir_ == DiagonalDir::Main ? Vec2<int>{1, 1} : Vec2<int>{1, -1});
+    }
+
+    DiagonalDir dir() const {
+        return dir_;
+    }
+};
+
+// Views of the rows of a char grid (or of a transposed grid/diagonals) as string_views, e.g. for std::string_view::find.
+inline std::string_view as_string_view(std::span<const char> cells) {
+    return std::string_view(cells.data(), cells.size());
+}
+
+inline std::string_view row_string_view(const Grid<char>& grid, int y)
+{
+    if (y < 0 || y >= grid.height()) {
+        throw std::out_of_range("row_string_view: invalid row");
+    }
+    return as_string_view(grid.elems().subspan(y * grid.width(), grid.width()));
+}
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <fstream>
+#include <filesystem>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include "grid.hpp"
+#include "hash.hpp"
+
+/*
+    Compact binary snapshots of a Grid<T> (for trivially copyable T), e.g. to checkpoint long running simulations
+    and restart from the last checkpoint at disk bandwidth instead of from scratch.
+    Layout: GridSnapshotHeader followed by the raw row-major elements (written with a single write call).
+    Snapshots are in host byte order, i.e. not meant to be moved between machines of different endianness.
+*/
+
+namespace aocutil
+{
+struct GridSnapshotHeader
+{
+    static constexpr char MAGIC[8] = {'A', 'O', 'C', 'G', 'R', 'I', 'D', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t elem_size;
+    int32_t width, height;
+    uint64_t tag;      // Free for the user, e.g. the simulation step the snapshot was taken at.
+    uint64_t checksum; // hash_bytes of the elements.
+};
+
+/*
+    Writes to "path.tmp" first and then renames it to path, so a crash while writing never destroys the previous snapshot.
+*/
+template<typename ElemType>
+void save_grid_snapshot(const Grid<ElemType>& grid, const std::filesystem::path& path, uint64_t tag = 0)
+{
+    static_assert(std::is_trivially_copyable_v<ElemType> && !std::is_same_v<ElemType, bool>, "save_grid_snapshot: ElemType must be trivially copyable (and not bool)");
+
+    const std::span<const ElemType> elems = grid.elems();
+    const std::size_t num_bytes = elems.size_bytes();
+
+    GridSnapshotHeader header;
+    std::memcpy(header.magic, GridSnapshotHeader::MAGIC, sizeof(header.magic));
+    header.version = GridSnapshotHeader::VERSION;
+    header.elem_size = sizeof(ElemType);
+    header.width = grid.width();
+    header.height = grid.height();
+    header.tag = tag;
+    header.checksum = hash_bytes(elems.data(), num_bytes);
+
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            throw std::runtime_error("save_grid_snapshot: Cannot open file '" + tmp_path.string() + "'");
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(elems.data()), num_bytes);
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("save_grid_snapshot: Writing '" + tmp_path.string() + "' failed");
+        }
+    }
+    std::filesystem::rename(tmp_path, path);
+}
+
+/*
+    Throws std::runtime_error if the file is not a valid snapshot of a Grid<ElemType> (wrong magic/version/element size,
+    truncated, or checksum mismatch). If tag is not null, the snapshot's tag is written to it.
+*/
+template<typename ElemType>
+Grid<ElemType> load_grid_snapshot(const std::filesystem::path& path, uint64_t* tag = nullptr)
+{
+    static_assert(std::is_trivially_copyable_v<ElemType> && !std::is_same_v<ElemType, bool>, "load_grid_snapshot: ElemType must be trivially copyable (and not bool)");
+
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error("load_grid_snapshot: Cannot open file '" + path.string() + "'");
+    }
+
+    GridSnapshotHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("load_grid_snapshot: File too short for header");
+    }
+    if (std::memcmp(header.magic, GridSnapshotHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("load_grid_snapshot: Not a grid snapshot (invalid magic)");
+    }
+    if (header.version != GridSnapshotHeader::VERSION) {
+        throw std::runtime_error("load_grid_snapshot: Unsupported snapshot version " + std::to_string(header.version));
+    }
+    if (header.elem_size != sizeof(ElemType)) {
+        throw std::runtime_error("load_grid_snapshot: Element size mismatch");
+    }
+    if (header.width < 0 || header.height < 0) {
+        throw std::runtime_error("load_grid_snapshot: Invalid dimensions");
+    }
+    const uint64_t num_elems = uint64_t(header.width) * uint64_t(header.height); // No overflow: Both are < 2^31.
+    if (num_elems > uint64_t(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("load_grid_snapshot: Invalid dimensions");
+    }
+    // Checked before the grid is allocated, so a corrupt header cannot request a huge allocation.
+    const std::streampos elems_begin = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff remaining_bytes = file.tellg() - elems_begin;
+    file.seekg(elems_begin);
+    if (!file || remaining_bytes < 0 || num_elems > uint64_t(remaining_bytes) / sizeof(ElemType)) {
+        throw std::runtime_error("load_grid_snapshot: File truncated");
+    }
+
+    Grid<ElemType> grid(header.width, header.height, ElemType{});
+    const std::span<ElemType> elems = grid.elems();
+    if (!file.read(reinterpret_cast<char*>(elems.data()), elems.size_bytes())) {
+        throw std::runtime_error("load_grid_snapshot: File truncated");
+    }
+    if (hash_bytes(elems.data(), elems.size_bytes()) != header.checksum) {
+        throw std::runtime_error("load_grid_snapshot: Checksum mismatch");
+    }
+    if (tag) {
+        *tag = header.tag;
+    }
+    return grid;
+}
+
+}
@@ -4,6 +4,7 @@
 #include <limits>
 #include <cassert>
 #include <optional>
+#include <span>
 #include "vec.hpp"
 
 namespace aocutil
@@ -327,9 +328,16 @@ class Grid
 
     using RowType = std::conditional_t<std::is_same<ElemType, char>::value, std::string, std::vector<ElemType>>;
 
+public: 
+    typedef ElemType value_type;
+
+    // Linear (row-major) indices; convert with calc_idx/idx_to_pos only where a Vec2 is actually needed (cf. PaddedGrid for bounds-check free neighbour offsets).
     int calc_idx(int x, int y) const {
         return x + y * width();
     }
+    int calc_idx(const Vec2<int>& pos) const {
+        return calc_idx(pos.x, pos.y);
+    }
 
     Vec2<int> idx_to_pos(int idx) const 
     {
@@ -340,8 +348,17 @@ class Grid
         return Vec2<int>{.x = x, .y = y};
     }
 
-public: 
-    typedef ElemType value_type;
+    int size() const {
+        return std::ssize(data);
+    }
+
+    // Direct access to the row-major element storage (e.g. for bulk I/O).
+    std::span<ElemType> elems() {
+        return data;
+    }
+    std::span<const ElemType> elems() const {
+        return data;
+    }
 
     Grid() = default; 
 
@@ -464,6 +481,17 @@ public:
         return data[calc_idx(pos.x, pos.y)]; 
     }
 
+    ElemType& operator[](int idx) 
+    {
+        assert(idx >= 0 && idx < std::ssize(data));
+        return data[idx]; 
+    }
+    const ElemType& operator[](int idx) const 
+    {
+        assert(idx >= 0 && idx < std::ssize(data));
+        return data[idx]; 
+    }
+
     bool pos_on_grid(int x, int y) const {
         bool on_grid = x >= 0 && x < width_ && y >= 0 && y < height_; 
         assert(!(on_grid && (calc_idx(x, y) >= std::ssize(data) || calc_idx(x, y) < 0)));
@@ -480,6 +508,8 @@ public:
         return width_;
     }
 
+    bool operator==(const Grid& other) const = default;
+
     GridIteratorMut begin() {
         return GridIteratorMut(0, 0, this);
     }
@@ -580,18 +610,18 @@ public:
 
     void foreach(const std::function<void(const Vec2<int>& pos, const ElemType& elem)>& fn) const {
         assert(std::ssize(data) == width() * height());
-        for (int idx = 0; idx < std::ssize(data); ++idx) {
-            const Vec2 pos = idx_to_pos(idx);
-            const ElemType& elem = at(pos);
-            fn(pos, elem);
+        for (int y = 0, idx = 0; y < height(); ++y) { // Nested loops so we don't need a div and a mod (idx_to_pos) for every element.
+            for (int x = 0; x < width(); ++x, ++idx) {
+                fn(Vec2<int>{.x = x, .y = y}, data[idx]);
+            }
         }
     }
     void foreach(const std::function<void(const Vec2<int>& pos, ElemType& elem)>& fn) {
         assert(std::ssize(data) == width() * height());
-        for (int idx = 0; idx < std::ssize(data); ++idx) {
-            const Vec2 pos = idx_to_pos(idx);
-            ElemType& elem = at(pos);
-            fn(pos, elem);
+        for (int y = 0, idx = 0; y < height(); ++y) {
+            for (int x = 0; x < width(); ++x, ++idx) {
+                fn(Vec2<int>{.x = x, .y = y}, data[idx]);
+            }
         }
     }
 
@@ -1,6 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <type_traits>
 
 /* 
     hash_combine copied verbatim from https://stackoverflow.com/a/57595105 (last retrieved 2024-06-20)
@@ -15,4 +23,123 @@ static inline void hash_combine(std::size_t& seed, const T& v, const Rest&... re
     seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     (hash_combine(seed, rest), ...);
 }
-}
\ No newline at end of file
+
+/*
+    splitmix64 finaliser, cf. https://prng.di.unimi.it/splitmix64.c (last retrieved 2024-12-20)
+    Also usable as a tiny deterministic PRNG by calling it on an incrementing state (state += 0x9e3779b97f4a7c15).
+*/
+constexpr uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+// Hashes a block of memory 8 bytes at a time (e.g. for checksums); not stable across platforms of different endianness.
+inline uint64_t hash_bytes(const void* data, std::size_t len, uint64_t seed = 0)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (len * 0x9e3779b97f4a7c15);
+    std::size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        h = std::rotl(h ^ splitmix64(word), 27) * 0x9e3779b97f4a7c15;
+    }
+    uint64_t tail = 0;
+    if (i < len) { // memcpy from nullptr (e.g. the elements of an empty grid) is undefined even for 0 bytes.
+        std::memcpy(&tail, bytes + i, len - i);
+    }
+    return splitmix64(h ^ splitmix64(tail));
+}
+
+/*
+    64 x 64 -> 128 bit multiplication, folded by xor-ing the high and low halves, as in wyhash. 
+    A single fold mixes every input bit into every output bit (unlike std::hash<int>, which is the identity on libstdc++).
+    cf. https://github.com/wangyi-fudan/wyhash (last retrieved 2024-12-20)
+*/
+constexpr uint64_t mum_fold(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+    const uint64_t a_lo = a & 0xffff'ffff, a_hi = a >> 32, b_lo = b & 0xffff'ffff, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffff'ffff) + lo_hi;
+    const uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    const uint64_t lo = (cross << 32) | (lo_lo & 0xffff'ffff);
+    return lo ^ hi;
+#endif
+}
+
+constexpr uint64_t HASH_MUL_0 = 0x9e3779b97f4a7c15, HASH_MUL_1 = 0xa0761d6478bd642f, HASH_MUL_2 = 0xe7037ed1a0b428db;
+
+constexpr uint64_t hash_u64(uint64_t x) {
+    return mum_fold(x ^ HASH_MUL_1, HASH_MUL_0);
+}
+
+// Combines two hashes (order dependent).
+constexpr uint64_t hash_mix(uint64_t h, uint64_t v) {
+    return mum_fold(h ^ HASH_MUL_1, v ^ HASH_MUL_2);
+}
+
+/*
+    Fast, well-mixed hash functor for integral types, enums, strings, std::pair/std::tuple of hashable types and other trivially
+    copyable types with unique object representations (hashed byte-wise). Unlike std::hash, it is safe to use for tables indexed 
+    by the low bits of the hash (i.e. power of two sizes). (Vec2 is specialised in vec.hpp.)
+    Not stable across platforms, and not meant to be DoS resistant.
+*/
+template<typename T>
+struct FastHash
+{
+    std::size_t operator()(const T& v) const noexcept
+    {
+        if constexpr (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) {
+            if constexpr (std::is_pointer_v<T>) {
+                return hash_u64(reinterpret_cast<std::uintptr_t>(v));
+            } else {
+                return hash_u64(static_cast<uint64_t>(v));
+            }
+        } else {
+            static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>, "FastHash: Type is neither integral nor trivially copyable without padding; specialise FastHash for it.");
+            return hash_bytes(&v, sizeof(T));
+        }
+    }
+};
+
+template<typename A, typename B>
+struct FastHash<std::pair<A, B>>
+{
+    std::size_t operator()(const std::pair<A, B>& p) const noexcept {
+        return hash_mix(FastHash<A>{}(p.first), FastHash<B>{}(p.second));
+    }
+};
+
+template<typename... Ts>
+struct FastHash<std::tuple<Ts...>>
+{
+    std::size_t operator()(const std::tuple<Ts...>& t) const noexcept
+    {
+        return std::apply([](const Ts&... elems) {
+            uint64_t h = sizeof...(Ts);
+            ((h = hash_mix(h, FastHash<Ts>{}(elems))), ...);
+            return h;
+        }, t);
+    }
+};
+
+// Transparent (cf. heterogeneous lookup): std::string, std::string_view and const char* hash equally.
+template<>
+struct FastHash<std::string_view>
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept {
+        return hash_bytes(s.data(), s.size());
+    }
+};
+
+template<>
+struct FastHash<std::string> : FastHash<std::string_view> {};
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <optional>
+#include "grid.hpp"
+#include "hash.hpp"
+
+namespace aocutil
+{
+/*
+    Grid wrapper which keeps a 64-bit Zobrist hash of its whole state up to date on every write (O(1) per set).
+    cf. https://en.wikipedia.org/wiki/Zobrist_hashing (last retrieved 2024-12-20)
+
+    Instead of a random key per (cell, symbol) pair, every cell gets one random key which is mixed with std::hash of
+    the element, so any hashable ElemType works. A cell's contribution only depends on (cell, elem), so a write just
+    xors out the old contribution and xors in the new one.
+    There is deliberately no mutable at()/operator[]/iterator access, as that would bypass the hash.
+*/
+template<typename ElemType>
+class HashedGrid
+{
+    Grid<ElemType> grid_;
+    std::vector<uint64_t> cell_keys;
+    uint64_t hash_ = 0;
+
+    uint64_t cell_hash(int idx, const ElemType& elem) const {
+        return splitmix64(cell_keys[idx] ^ static_cast<uint64_t>(std::hash<ElemType>{}(elem)));
+    }
+
+    void init_hash(uint64_t seed)
+    {
+        const int num_cells = grid_.width() * grid_.height();
+        cell_keys.resize(num_cells);
+        for (int idx = 0; idx < num_cells; ++idx) {
+            cell_keys[idx] = splitmix64(seed + idx); // Deterministic, so hashes are reproducible across runs.
+        }
+        hash_ = 0;
+        for (int y = 0; y < grid_.height(); ++y) {
+            for (int x = 0; x < grid_.width(); ++x) {
+                hash_ ^= cell_hash(x + y * grid_.width(), grid_[Vec2<int>{x, y}]);
+            }
+        }
+    }
+
+public:
+    typedef ElemType value_type;
+    static constexpr uint64_t DEFAULT_SEED = 0x2024'12'20;
+
+    HashedGrid() = default;
+
+    explicit HashedGrid(const Grid<ElemType>& grid, uint64_t seed = DEFAULT_SEED) : grid_{grid}
+    {
+        init_hash(seed);
+    }
+
+    HashedGrid(int width, int height, const ElemType& init_val, uint64_t seed = DEFAULT_SEED) : grid_{width, height, init_val}
+    {
+        init_hash(seed);
+    }
+
+    uint64_t hash() const {
+        return hash_;
+    }
+
+    const Grid<ElemType>& grid() const {
+        return grid_;
+    }
+
+    void set(int x, int y, const ElemType& e)
+    {
+        if (!pos_on_grid(x, y)) {
+            throw std::out_of_range("HashedGrid set: invalid position");
+        }
+        const int idx = x + y * width();
+        ElemType& cell = grid_.at(x, y);
+        hash_ ^= cell_hash(idx, cell);
+        cell = e;
+        hash_ ^= cell_hash(idx, cell);
+    }
+    void set(const Vec2<int>& pos, const ElemType& e) {
+        set(pos.x, pos.y, e);
+    }
+
+    bool try_set(int x, int y, const ElemType& e)
+    {
+        if (!pos_on_grid(x, y)) {
+            return false;
+        }
+        set(x, y, e);
+        return true;
+    }
+    bool try_set(const Vec2<int>& pos, const ElemType& e) {
+        return try_set(pos.x, pos.y, e);
+    }
+
+    ElemType get(int x, int y) const {
+        return grid_.get(x, y);
+    }
+    ElemType get(const Vec2<int>& pos) const {
+        return grid_.get(pos);
+    }
+
+    std::optional<ElemType> try_get(int x, int y) const {
+        return grid_.try_get(x, y);
+    }
+    std::optional<ElemType> try_get(const Vec2<int>& pos) const {
+        return grid_.try_get(pos);
+    }
+
+    const ElemType& at(int x, int y) const {
+        return grid_.at(x, y);
+    }
+    const ElemType& at(const Vec2<int>& pos) const {
+        return grid_.at(pos);
+    }
+
+    bool pos_on_grid(int x, int y) const {
+        return grid_.pos_on_grid(x, y);
+    }
+    bool pos_on_grid(const Vec2<int>& pos) const {
+        return grid_.pos_on_grid(pos);
+    }
+
+    int width() const {
+        return grid_.width();
+    }
+    int height() const {
+        return grid_.height();
+    }
+
+    // Only does the O(W*H) comparison if the hashes match (i.e. the grids are equal or we got a collision).
+    bool operator==(const HashedGrid& other) const {
+        return hash_ == other.hash_ && grid_ == other.grid_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const HashedGrid<ElemType>& g) {
+        return os << g.grid_;
+    }
+};
+
+struct CycleInfo
+{
+    int64_t start;  // Number of steps until the first state which is part of the cycle is reached ("mu").
+    int64_t length; // Length of the cycle ("lambda").
+};
+
+/*
+    Brent's cycle detection on the sequence x0, step(x0), step(step(x0)), ...
+    cf. https://en.wikipedia.org/wiki/Cycle_detection#Brent's_algorithm (last retrieved 2024-12-20)
+
+    - step(State&) advances a state in-place; hash_fn(const State&) returns its (e.g. Zobrist) hash, so states
+      are compared in O(1) instead of element by element.
+    - If verify is true, matching hashes are confirmed with State::operator== to rule out hash collisions.
+    - Only O(log(mu + lambda)) state copies are made.
+    Returns an empty optional if no cycle is found within max_steps steps.
+*/
+template<typename State, typename StepFn, typename HashFn>
+std::optional<CycleInfo> find_cycle(const State& x0, StepFn step, HashFn hash_fn, bool verify = false, int64_t max_steps = std::numeric_limits<int64_t>::max())
+{
+    const auto states_equal = [&hash_fn, verify](const State& a, const State& b) -> bool {
+        return hash_fn(a) == hash_fn(b) && (!verify || a == b);
+    };
+
+    // 1.) Find the cycle length (lambda) by letting the hare run ahead in powers of two.
+    int64_t power = 1, lambda = 1, steps = 1;
+    State tortoise = x0;
+    State hare = x0;
+    step(hare);
+    while (!states_equal(tortoise, hare)) {
+        if (steps >= max_steps) {
+            return {};
+        }
+        if (power == lambda) {
+            tortoise = hare;
+            power *= 2;
+            lambda = 0;
+        }
+        step(hare);
+        ++lambda;
+        ++steps;
+    }
+
+    // 2.) Find the start of the cycle (mu) with tortoise and hare lambda steps apart.
+    tortoise = x0;
+    hare = x0;
+    for (int64_t i = 0; i < lambda; ++i) {
+        step(hare);
+    }
+    int64_t mu = 0;
+    while (!states_equal(tortoise, hare)) {
+        step(tortoise);
+        step(hare);
+        ++mu;
+    }
+    assert(lambda > 0);
+    return CycleInfo{.start = mu, .length = lambda};
+}
+
+}
+
+template<typename ElemType>
+struct std::hash<aocutil::HashedGrid<ElemType>>
+{
+    std::size_t operator()(const aocutil::HashedGrid<ElemType>& g) const noexcept
+    {
+        return g.hash();
+    }
+};
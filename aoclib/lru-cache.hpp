@@ -1,232 +1,625 @@
 #pragma once
 
+#include <new>
+#include <bit>
 #include <array>
-#include <unordered_map>
+#include <string>
+#include <limits>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <cassert>
+#include <cstdint>
+#include <ostream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include "flat-hash.hpp"
+#include "eviction-policy.hpp"
 
-namespace aocutil 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/*
+    Compile with -DAOC_LRU_STATS=1 to make every LRUCache count its hits, misses, inserts, updates and evictions, and
+    sample the reuse distances of its hits (cf. LRUStats; only for EvictionPolicy::LRU). Without it, the counters are compiled out and stats() is empty.
+    (The macro has to have the same value in all translation units which use LRUCache.)
+*/
+#ifndef AOC_LRU_STATS
+#define AOC_LRU_STATS 0
+#endif
+
+namespace aocutil
 {
 /*
     General idea: https://stackoverflow.com/questions/2504178/lru-cache-design/54272232#54272232 (last retrieved 2024-06-16)
     Instead of using std::list, a custom intrusive doubly linked list is used, which means
-    all nodes of the linked list will be stored in the same array instead of potentially all over the heap. 
-*/ 
+    all nodes of the linked list will be stored in the same array instead of potentially all over the heap.
+
+    The capacity is chosen at runtime (N is only the default capacity; LRUCache<Key, Val> needs an explicit one), and the
+    node array is a single heap allocation, so even caches with millions of entries are small objects which can live on
+    the stack. reserve/shrink move the nodes into a new allocation at the same indices (which is what the map stores), so
+    the map is not rehashed; shrink only updates the map entries of the nodes it has to move below the new capacity.
+
+    Which element is evicted is up to the policy (cf. eviction-policy.hpp): LRU (the default) keeps the intrusive list
+    described above, Clock/TwoQ/ARC are scan-resistant alternatives. All of them only store node indices, so the node
+    pool, the map and the API are the same for every policy.
+*/
+
+enum class LRUPages {Default, Huge}; // Huge: Back the node pool with transparent huge pages (Linux only, ignored elsewhere).
+
+namespace lru_impl
+{
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+
+// Uninitialised storage for a fixed number of Slots (Slot must be an implicit-lifetime type, i.e. only links and raw bytes).
+template<typename Slot>
+class SlotPool
+{
+    Slot* slots = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t mapped_bytes = 0; // > 0 if allocated with mmap.
+
+    void release()
+    {
+#if defined(__linux__)
+        if (mapped_bytes) {
+            munmap(slots, mapped_bytes);
+            slots = nullptr;
+            return;
+        }
+#endif
+        ::operator delete(slots, std::align_val_t{alignof(Slot)});
+        slots = nullptr;
+    }
+
+public:
+    SlotPool() = default;
+    SlotPool(std::size_t capacity, [[maybe_unused]] LRUPages pages) : capacity_{capacity}
+    {
+#if defined(__linux__)
+        if (pages == LRUPages::Huge) {
+            mapped_bytes = (capacity * sizeof(Slot) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            void* mem = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            madvise(mem, mapped_bytes, MADV_HUGEPAGE); // Only a hint (transparent huge pages might be disabled).
+            slots = static_cast<Slot*>(mem);
+            return;
+        }
+#endif
+        slots = static_cast<Slot*>(::operator new(capacity * sizeof(Slot), std::align_val_t{alignof(Slot)}));
+    }
+    SlotPool(const SlotPool&) = delete;
+    SlotPool& operator=(const SlotPool&) = delete;
+    SlotPool(SlotPool&& other) noexcept
+        : slots{std::exchange(other.slots, nullptr)}, capacity_{std::exchange(other.capacity_, 0)}, mapped_bytes{std::exchange(other.mapped_bytes, 0)} {}
+    SlotPool& operator=(SlotPool&& other) noexcept
+    {
+        std::swap(slots, other.slots);
+        std::swap(capacity_, other.capacity_);
+        std::swap(mapped_bytes, other.mapped_bytes);
+        return *this;
+    }
+    ~SlotPool()
+    {
+        if (slots) {
+            release();
+        }
+    }
 
-template<typename Key, typename Val, std::size_t N>
-class LRUCache 
+    Slot& operator[](std::size_t i)
+    {
+        assert(i < capacity_);
+        return slots[i];
+    }
+    const Slot& operator[](std::size_t i) const
+    {
+        assert(i < capacity_);
+        return slots[i];
+    }
+    std::size_t size() const {
+        return capacity_;
+    }
+};
+}
+
+/*
+    Counters of an LRUCache (only counted with AOC_LRU_STATS):
+    - hits/misses: Lookups by find, get_copy, get_ptr, try_emplace and get_or_compute (peek and contains don't count).
+    - inserts: New elements, updates: insert of an already cached key, evictions: Elements evicted to make room (or by shrink).
+    - Reuse distance of a hit: Number of elements which were used more recently than the element, i.e. its position in
+      the LRU list. A cache of capacity c (power of two) would have hit exactly the lookups with distances < c (LRU caches
+      of different capacities contain each other), so the histogram estimates the hit rate for other capacities.
+      Finding the position walks the list, so only about every REUSE_SAMPLE_INTERVAL-th lookup is sampled.
+      cf. https://en.wikipedia.org/wiki/Cache_performance_measurement_and_metric#Reuse_distance (last retrieved 2024-12-20)
+*/
+struct LRUStats
+{
+    static constexpr uint64_t REUSE_SAMPLE_INTERVAL = 256;
+    static constexpr int REUSE_DISTANCE_BUCKETS = 33; // Bucket 0: Distance 0, bucket i > 0: Distances in [2^(i - 1), 2^i).
+
+    uint64_t hits = 0, misses = 0, inserts = 0, updates = 0, evictions = 0;
+    uint64_t reuse_samples = 0; // Sampled lookups (hits and misses).
+    std::array<uint64_t, REUSE_DISTANCE_BUCKETS> reuse_distance{}; // Sampled hits by reuse distance.
+
+    static int bucket_of(uint64_t distance) {
+        return std::min(static_cast<int>(std::bit_width(distance)), REUSE_DISTANCE_BUCKETS - 1);
+    }
+    static uint64_t bucket_end(int bucket) {
+        return uint64_t{1} << bucket;
+    }
+
+    double hit_rate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+
+    // Estimated hit rate with the given capacity (a power of two at most the actual capacity) from the sampled reuse distances.
+    double estimated_hit_rate(uint64_t capacity) const
+    {
+        if (!std::has_single_bit(capacity)) {
+            throw std::invalid_argument("LRUStats estimated_hit_rate: Capacity must be a power of two");
+        }
+        uint64_t sampled_hits = 0;
+        for (int i = 0; i < REUSE_DISTANCE_BUCKETS && bucket_end(i) <= capacity; ++i) {
+            sampled_hits += reuse_distance[i];
+        }
+        return reuse_samples == 0 ? 0.0 : static_cast<double>(sampled_hits) / reuse_samples;
+    }
+
+    LRUStats& operator+=(const LRUStats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        inserts += other.inserts;
+        updates += other.updates;
+        evictions += other.evictions;
+        reuse_samples += other.reuse_samples;
+        for (int i = 0; i < REUSE_DISTANCE_BUCKETS; ++i) {
+            reuse_distance[i] += other.reuse_distance[i];
+        }
+        return *this;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const LRUStats& stats)
+    {
+        const std::ios_base::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "hits: " << stats.hits << ", misses: " << stats.misses << " (hit rate: " << std::fixed << std::setprecision(3) << stats.hit_rate()
+           << "), inserts: " << stats.inserts << ", updates: " << stats.updates << ", evictions: " << stats.evictions << "\n";
+        os << "reuse distances (" << stats.reuse_samples << " sampled lookups):\n";
+        int last_bucket = -1;
+        for (int i = 0; i < REUSE_DISTANCE_BUCKETS; ++i) {
+            if (stats.reuse_distance[i] > 0) {
+                os << "    [" << (i == 0 ? 0 : bucket_end(i - 1)) << ", " << bucket_end(i) << "): " << stats.reuse_distance[i] << "\n";
+                last_bucket = i;
+            }
+        }
+        os << "estimated hit rate by capacity:";
+        for (int i = 0; i <= last_bucket; ++i) {
+            os << " " << bucket_end(i) << ": " << stats.estimated_hit_rate(bucket_end(i)) << (i < last_bucket ? "," : "");
+        }
+        os.flags(flags);
+        os.precision(precision);
+        return os << "\n";
+    }
+};
+
+template<typename Key, typename Val, std::size_t N = 0, typename Hash = FastHash<Key>, EvictionPolicy policy = EvictionPolicy::LRU>
+class LRUCache
 {
 private:
-    using ValNodeIdx = uint32_t; 
-    static const ValNodeIdx IDX_NULL = std::numeric_limits<ValNodeIdx>::max(); 
-    static_assert(N > 0 && N < IDX_NULL);
-    
+    using ValNodeIdx = eviction_impl::Idx;
+    static constexpr ValNodeIdx IDX_NULL = eviction_impl::IDX_NULL;
+    static_assert(N < IDX_NULL);
+
     struct ValNode {
         Key key;
         Val data;
-        ValNodeIdx prev_idx, next_idx; 
+    };
+    // The ValNode only exists while the slot is used, i.e. while the map has an entry pointing to it.
+    struct Slot {
+        alignas(ValNode) unsigned char storage[sizeof(ValNode)];
     };
 
-    std::unordered_map<Key, ValNodeIdx> map;
+    FlatMap<Key, ValNodeIdx, Hash> map;
 
-    // The array is used as an object pool holding the nodes of a doubly-linked intrusive linked list.  
+    // The pool holds the nodes; the order in which they are evicted is kept by the policy (e.g. a doubly-linked intrusive list of node indices for LRU).
     // cf. http://gameprogrammingpatterns.com/object-pool.html (last retrieved 2024-06-16)
-    std::array<ValNode, N> nodes; 
-    ValNodeIdx size_;
-    ValNodeIdx first_free_idx;
-    ValNodeIdx head_idx, tail_idx;
+    lru_impl::SlotPool<Slot> nodes;
+    eviction_impl::Policy<policy, Key, Hash> policy_;
+    std::vector<ValNodeIdx> free_idxs; // Unused slots (descending, so low indices are used first).
+    LRUPages pages_ = LRUPages::Default;
+#if AOC_LRU_STATS
+    LRUStats stats_;
+    std::string stats_label; // Dump the stats on destruction if not empty.
+#endif
+
+    ValNode& node(ValNodeIdx idx) {
+        return *std::launder(reinterpret_cast<ValNode*>(nodes[idx].storage));
+    }
+    const ValNode& node(ValNodeIdx idx) const {
+        return *std::launder(reinterpret_cast<const ValNode*>(nodes[idx].storage));
+    }
 
-    ValNodeIdx get_free_idx()
+    void count_stat([[maybe_unused]] uint64_t LRUStats::* counter)
     {
-        if (first_free_idx == IDX_NULL) {
-            return IDX_NULL;
+#if AOC_LRU_STATS
+        ++(stats_.*counter);
+#endif
+    }
+
+    // Counts a lookup of the node idx (IDX_NULL for a miss), before the policy is told about it.
+    void count_lookup([[maybe_unused]] ValNodeIdx idx)
+    {
+#if AOC_LRU_STATS
+        count_stat(idx == IDX_NULL ? &LRUStats::misses : &LRUStats::hits);
+        if constexpr (policy == EvictionPolicy::LRU) { // Other policies don't keep the recency order.
+            if (splitmix64(stats_.hits + stats_.misses) % LRUStats::REUSE_SAMPLE_INTERVAL != 0) { // Pseudo-random, so periodic access patterns don't bias the samples.
+                return;
+            }
+            ++stats_.reuse_samples;
+            if (idx != IDX_NULL) {
+                ++stats_.reuse_distance[LRUStats::bucket_of(policy_.recency_rank(idx))];
+            }
         }
-        assert(first_free_idx < N); 
-        ValNodeIdx free_idx = first_free_idx;
+#endif
+    }
 
-        ValNode& vn = nodes.at(first_free_idx);
-        first_free_idx = vn.next_idx; 
+    // All slots which are not used (i.e. not in the map) are free.
+    void rebuild_free_list()
+    {
+        std::vector<bool> used(nodes.size(), false);
+        for (const auto& [key, idx] : map) {
+            used[idx] = true;
+        }
+        free_idxs.clear();
+        for (std::size_t i = nodes.size(); i-- > 0; ) {
+            if (!used[i]) {
+                free_idxs.push_back(static_cast<ValNodeIdx>(i));
+            }
+        }
+    }
 
-        return free_idx;
+    void destroy_all()
+    {
+        for (const auto& [key, idx] : map) {
+            node(idx).~ValNode();
+        }
+        map.clear();
+        policy_.clear();
     }
 
-    void reset_free_list() {
-        size_ = first_free_idx = 0; 
-        head_idx = tail_idx = IDX_NULL; 
-        for (ValNodeIdx i = 0; i < nodes.size(); ++i) { // Set up the free list. 
-            nodes.at(i).prev_idx = (i == 0) ? IDX_NULL : i - 1; 
-            nodes.at(i).next_idx = (i == nodes.size() - 1) ? IDX_NULL : i + 1; 
+    // Evicts the element the policy chooses (for shrink).
+    void evict_one()
+    {
+        const ValNodeIdx idx = policy_.victim();
+        map.erase(node(idx).key);
+        policy_.on_evict(idx, node(idx).key);
+        node(idx).~ValNode();
+        free_idxs.push_back(idx);
+        count_stat(&LRUStats::evictions);
+    }
+
+    // Moves all nodes into a new pool of new_capacity slots (all used indices must be < new_capacity), keeping their indices.
+    void reallocate(std::size_t new_capacity)
+    {
+        lru_impl::SlotPool<Slot> new_nodes(new_capacity, pages_);
+        for (const auto& [key, idx] : map) {
+            assert(idx < new_capacity);
+            ValNode& old_node = node(idx);
+            ::new (static_cast<void*>(new_nodes[idx].storage)) ValNode(std::move(old_node));
+            old_node.~ValNode();
         }
+        nodes = std::move(new_nodes);
+        policy_.resize(new_capacity);
+        rebuild_free_list();
+    }
+
+    // Stores the new element (whose map entry already points to idx) in node idx, which is either free or the policy's victim (evict).
+    template<typename... Args>
+    void emplace_new(const Key& key, ValNodeIdx idx, bool evict, Args&&... args)
+    {
+        try {
+            if (evict) {
+                Val val(std::forward<Args>(args)...); // Constructed before anything is evicted, in case it throws.
+                map.erase(node(idx).key);
+                policy_.on_evict(idx, node(idx).key);
+                count_stat(&LRUStats::evictions);
+                try {
+                    node(idx).key = key;
+                    node(idx).data = std::move(val);
+                } catch (...) {
+                    node(idx).~ValNode();
+                    free_idxs.push_back(idx);
+                    throw;
+                }
+            } else {
+                free_idxs.pop_back();
+                try {
+                    ::new (static_cast<void*>(nodes[idx].storage)) ValNode{key, Val(std::forward<Args>(args)...)};
+                } catch (...) {
+                    free_idxs.push_back(idx);
+                    throw;
+                }
+            }
+        } catch (...) {
+            map.erase(key);
+            throw;
+        }
+        policy_.on_insert(idx, key);
+        count_stat(&LRUStats::inserts);
+    }
+
+    // try_emplace, which only counts the lookup if is_lookup (get_or_compute and insert count their own).
+    template<typename... Args>
+    std::pair<Val*, bool> try_emplace_impl(bool is_lookup, const Key& key, Args&&... args)
+    {
+        const auto [it, inserted] = map.try_emplace(key, IDX_NULL);
+        if (!inserted) {
+            if (is_lookup) {
+                count_lookup(it->second);
+            }
+            policy_.on_hit(it->second);
+            return {&node(it->second).data, false};
+        }
+        if (is_lookup) {
+            count_lookup(IDX_NULL);
+        }
+        policy_.on_miss(key);
+        const bool evict = free_idxs.empty();
+        const ValNodeIdx idx = evict ? policy_.victim() : free_idxs.back();
+        it->second = idx; // Before the map is modified again (which invalidates it).
+        emplace_new(key, idx, evict, std::forward<Args>(args)...);
+        return {&node(idx).data, true};
     }
 
 public:
-    LRUCache() : size_{0}, first_free_idx{0}, head_idx{IDX_NULL}, tail_idx{IDX_NULL}
+    LRUCache(std::size_t capacity = N, LRUPages pages = LRUPages::Default) : policy_(capacity), pages_{pages}
     {
-        reset_free_list();
+        if (capacity == 0 || capacity >= IDX_NULL) {
+            throw std::invalid_argument("LRUCache::LRUCache: Invalid capacity");
+        }
+        nodes = lru_impl::SlotPool<Slot>(capacity, pages);
+        rebuild_free_list(); // The map is not reserved up front: It grows with the number of cached elements, which might stay far below the capacity.
     }
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+    LRUCache(LRUCache&& other) noexcept
+        : map{std::move(other.map)}, nodes{std::move(other.nodes)}, policy_{std::move(other.policy_)}, free_idxs{std::move(other.free_idxs)}, pages_{other.pages_}
+    {
+        other.map.clear();
+#if AOC_LRU_STATS
+        stats_ = std::exchange(other.stats_, LRUStats{});
+        stats_label = std::exchange(other.stats_label, std::string{});
+#endif
+    }
+    LRUCache& operator=(LRUCache&& other) noexcept
+    {
+        if (this != &other) {
+            destroy_all();
+            map = std::move(other.map);
+            other.map.clear();
+            nodes = std::move(other.nodes);
+            policy_ = std::move(other.policy_);
+            free_idxs = std::move(other.free_idxs);
+            pages_ = other.pages_;
+#if AOC_LRU_STATS
+            stats_ = std::exchange(other.stats_, LRUStats{});
+            stats_label = std::exchange(other.stats_label, std::string{});
+#endif
+        }
+        return *this;
+    }
+    ~LRUCache()
+    {
+#if AOC_LRU_STATS
+        if (!stats_label.empty()) {
+            std::cerr << "LRUCache \"" << stats_label << "\" (capacity " << capacity() << ", size " << size() << "): " << stats_;
+        }
+#endif
+        destroy_all();
+    }
+
+    static constexpr bool has_stats = AOC_LRU_STATS;
 
-    void clear() 
+    // All zero without AOC_LRU_STATS.
+    LRUStats stats() const
     {
-        reset_free_list();
-        map.clear();
+#if AOC_LRU_STATS
+        return stats_;
+#else
+        return {};
+#endif
     }
 
-    ValNodeIdx size() const 
+    void reset_stats()
     {
-        return size_;
+#if AOC_LRU_STATS
+        stats_ = LRUStats{};
+#endif
     }
 
-    void insert(const Key& key, const Val& val)
+    // Prints the stats (labelled with label) to std::cerr when the cache is destroyed, e.g. at exit for static caches (no-op without AOC_LRU_STATS).
+    void dump_stats_on_destruction([[maybe_unused]] std::string label)
     {
-        // 1.) The key is already inside the cache: 
-        if (map.contains(key)) { 
-            ValNodeIdx vn_idx = map.at(key); 
-            assert(vn_idx != IDX_NULL);
-            ValNode& vn = nodes.at(vn_idx);
-            if (vn.data != val) {
-                vn.data = val; 
-            }
+#if AOC_LRU_STATS
+        stats_label = std::move(label);
+#endif
+    }
 
-            if (vn_idx == head_idx) { // Node was already head.
-                assert(vn.prev_idx == IDX_NULL);
-                return; 
-            }
+    void clear()
+    {
+        destroy_all();
+        rebuild_free_list();
+    }
 
-            if (vn_idx == tail_idx) { // Node was tail.
-                assert(vn.next_idx == IDX_NULL);
-                if (head_idx == tail_idx) {
-                    assert(size_ == 1); 
-                } else {
-                    tail_idx = vn.prev_idx;
-                }
-            }
+    ValNodeIdx size() const
+    {
+        return static_cast<ValNodeIdx>(map.size());
+    }
+
+    std::size_t capacity() const
+    {
+        return nodes.size();
+    }
+
+    // Grows the capacity to new_capacity (no-op if it is not larger); the cached elements are kept.
+    void reserve(std::size_t new_capacity)
+    {
+        if (new_capacity <= capacity()) {
+            return;
+        }
+        if (new_capacity >= IDX_NULL) {
+            throw std::invalid_argument("LRUCache reserve: Invalid capacity");
+        }
+        reallocate(new_capacity);
+    }
 
-            // Pull out of pool. 
-            assert(vn.prev_idx != IDX_NULL);
-            if (vn.prev_idx != IDX_NULL) { 
-                nodes.at(vn.prev_idx).next_idx = vn.next_idx; 
-            } 
-            if (vn.next_idx != IDX_NULL) {
-                nodes.at(vn.next_idx).prev_idx = vn.prev_idx; 
-            } 
-
-            // Re-insert at the head of the list.
-            vn.prev_idx = IDX_NULL; 
-            vn.next_idx = head_idx; 
-            if (head_idx != IDX_NULL) {
-                nodes.at(head_idx).prev_idx = vn_idx;
+    // Shrinks the capacity to new_capacity (no-op if it is not smaller), evicting elements (chosen by the policy) if necessary.
+    void shrink(std::size_t new_capacity)
+    {
+        if (new_capacity == 0) {
+            throw std::invalid_argument("LRUCache shrink: Invalid capacity");
+        }
+        if (new_capacity >= capacity()) {
+            return;
+        }
+        while (size() > new_capacity) {
+            evict_one();
+        }
+        // Compact: Move the nodes at indices >= new_capacity into the unused slots below new_capacity.
+        std::vector<bool> used(new_capacity, false);
+        for (const auto& [key, idx] : map) {
+            if (idx < new_capacity) {
+                used[idx] = true;
             }
-            head_idx = vn_idx; 
-            return; 
-        }
-
-        // 2.) The key is not yet inside the cache:
-        ValNodeIdx idx = get_free_idx(); 
-        if (idx == IDX_NULL) { // a) Cache is full, remove the least recently used element to make space.
-            assert(size_ == N);
-            assert(tail_idx != IDX_NULL);
-            ValNodeIdx to_delete_idx = tail_idx; 
-            assert(to_delete_idx != IDX_NULL && to_delete_idx < N);
-            ValNode& to_del = nodes.at(to_delete_idx); 
-            map.erase(to_del.key);
-
-            if (to_del.prev_idx != IDX_NULL) { // Update Tail. 
-                assert(to_del.prev_idx < N);
-                ValNode& new_tail_node = nodes.at(to_del.prev_idx); 
-                new_tail_node.next_idx = IDX_NULL; 
-                tail_idx = to_del.prev_idx;
-                assert(to_del.prev_idx == to_del.prev_idx);
+        }
+        ValNodeIdx to_idx = 0;
+        for (auto& [key, idx] : map) {
+            if (idx >= new_capacity) {
+                while (used[to_idx]) {
+                    ++to_idx;
+                }
+                used[to_idx] = true;
+                ValNode& from = node(idx);
+                ::new (static_cast<void*>(nodes[to_idx].storage)) ValNode(std::move(from));
+                from.~ValNode();
+                policy_.relocate(idx, to_idx);
+                idx = to_idx;
             }
-            // Update free list. 
-            to_del.prev_idx = IDX_NULL; 
-            to_del.next_idx = first_free_idx; 
-            first_free_idx = to_delete_idx;  
+        }
+        reallocate(new_capacity);
+    }
 
-            idx = get_free_idx(); 
-            assert(idx != IDX_NULL);
-        } else { // b) Cache was not full.
-            ++size_; 
-            assert(size_ <= N);
+    /*
+        Returns a pointer to the value of key (and marks it as used), or nullptr if key is not cached.
+        Dangerous:
+            Only dereference the pointer as long as you haven't inserted any new keys into the lru-cache yet after
+            having obtained the pointer. (Inserting a new key might evict the element and reuse its node for the new key,
+            so the pointer would point to an incorrect value.)
+            -> In most cases, just use get_copy.
+    */
+    Val* find(const Key& key)
+    {
+        const auto it = map.find(key);
+        if (it == map.end()) {
+            count_lookup(IDX_NULL);
+            return nullptr;
         }
+        count_lookup(it->second);
+        policy_.on_hit(it->second);
+        return &node(it->second).data;
+    }
 
-        ValNode& vn = nodes.at(idx); 
-        vn.key = key;
-        vn.data = val;
+    // Like find, but does not mark the element as used (so it can be called on a const cache).
+    const Val* peek(const Key& key) const
+    {
+        const auto it = map.find(key);
+        return it == map.end() ? nullptr : &node(it->second).data;
+    }
 
-        ValNodeIdx old_head_idx = head_idx; 
-        head_idx = idx; 
-        if (tail_idx == IDX_NULL) {
-            assert(size_ == 1); 
-            tail_idx = head_idx; 
+    /*
+        Returns a pointer to the value of key and false if key is already cached (the value is not changed then, and args are
+        not used), otherwise constructs the value from args, evicting an element (chosen by the policy, e.g. the least
+        recently used one) if the cache is full, and returns a pointer to it and true.
+        Only one lookup of key: The map entry of a new key is created by the lookup itself, and then pointed to the node the
+        value will be stored in (the first free one, or the evicted one, whose storage is reused by assignment).
+        The pointer is invalidated like the one returned by find.
+    */
+    template<typename... Args>
+    std::pair<Val*, bool> try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(true, key, std::forward<Args>(args)...);
+    }
+
+    /*
+        Returns the value of key, which is computed with fn() (and inserted like by try_emplace) if key is not cached.
+        fn may use the cache itself (e.g. for recursive memoisation), so it is called while the cache is in a consistent
+        state, which means a miss takes a second lookup after fn() returns; a hit takes one.
+        The reference is invalidated like the pointer returned by find.
+    */
+    template<typename Fn>
+    Val& get_or_compute(const Key& key, Fn&& fn)
+    {
+        if (Val* val = find(key)) {
+            return *val;
         }
+        return *try_emplace_impl(false, key, std::forward<Fn>(fn)()).first;
+    }
 
-        vn.prev_idx = IDX_NULL; 
-        vn.next_idx = old_head_idx; 
-        if (old_head_idx != IDX_NULL) {
-            nodes.at(old_head_idx).prev_idx = idx;
+    // Inserts val for key, or assigns it if key is already cached.
+    template<typename V = Val>
+    void insert(const Key& key, V&& val)
+    {
+        const auto [data, inserted] = try_emplace_impl(false, key, std::forward<V>(val));
+        if (!inserted) {
+            *data = std::forward<V>(val); // Not moved from by try_emplace if the key was already cached.
+            count_stat(&LRUStats::updates);
         }
-        map.insert({key, idx});
     }
 
-    bool contains(const Key& key) const 
+    bool contains(const Key& key) const
     {
         return map.contains(key);
     }
 
-    std::optional<Val> get_copy(const Key& key) 
+    std::optional<Val> get_copy(const Key& key)
     {
-        if (!map.contains(key)) {
-            return {};
+        if (const Val* val = find(key)) {
+            return *val;
         }
-        ValNodeIdx vn_idx = map.at(key); 
-        assert(vn_idx != IDX_NULL);
-        ValNode& vn = nodes.at(vn_idx);
-        insert(key, vn.data); // Re-insert into head. 
-        return vn.data;
+        return {};
     }
 
-    /* 
-        Dangerous:   
-            Only dereference the pointer obtained by get_ptr as long as you haven't
-            inserted any new keys into the lru-cache yet after having obtained the pointer.
-            (As soon you have inserted new keys into the lru-cache after having obtained a pointer with get_ptr, 
-            that pointer might point to an incorrect value, i.e. the ponter points only to the right value if you have 
-            not yet called .insert after having obtained the pointer.)
-            -> In most cases, just use get_copy. 
-    */
-    Val *get_ptr(const Key& key) 
+    // Same as find (cf. the warning there).
+    Val *get_ptr(const Key& key)
     {
-        if (!map.contains(key)) {
-            return NULL; 
-        }
-        ValNodeIdx vn_idx = map.at(key); 
-        assert(vn_idx != IDX_NULL);
-        ValNode& vn = nodes.at(vn_idx);
-        insert(key, vn.data); // Re-insert into head. 
-        return &vn.data;
+        return find(key);
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const LRUCache<Key, Val, N>& cache)
+    // Prints the elements in the policy's order (for LRU: most recently used first, marked as HEAD).
+    friend std::ostream& operator<<(std::ostream& os, const LRUCache& cache)
     {
-        os << "size: " << cache.size <<"\n"; 
-        size_t idx = cache.head_idx; 
-        [[maybe_unused]] size_t prev_idx = LRUCache::IDX_NULL; 
-        while (idx != LRUCache<Key, Val, N>::IDX_NULL ) {
-            const auto& v = cache.nodes.at(idx); 
-
+        os << "size: " << cache.size() <<"\n";
+        std::size_t i = 0;
+        cache.policy_.for_each([&os, &cache, &i](ValNodeIdx idx) {
+            const auto& v = cache.node(idx);
             os << "key: " << v.key << ", val: " << v.data;
-            if (idx == cache.head_idx) {
-                os << " (HEAD)"; 
-            }
-            if (idx == cache.tail_idx) {
-                os << " (TAIL)";
+            if constexpr (policy == EvictionPolicy::LRU) {
+                if (i == 0) {
+                    os << " (HEAD)";
+                }
+                if (i + 1 == cache.size()) {
+                    os << " (TAIL)";
+                }
             }
             os << "\n";
-            assert(v.prev_idx == prev_idx);
-
-            prev_idx = idx;
-            idx = v.next_idx;
-        }
+            ++i;
+        });
         return os;
     }
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cassert>
+#include <optional>
+#include "grid.hpp"
+#include "vec.hpp"
+
+namespace aocutil
+{
+/*
+    Corridor-compressed graph of a maze: Only junctions (open cells with more or less than two open neighbours, i.e.
+    also dead ends) and explicitly kept cells (e.g. start and end) become nodes; every corridor between two nodes
+    becomes one edge (in both directions) which remembers its length, its number of turns and the cells it covers.
+    On mazes which mostly consist of corridors, this shrinks the search graph by roughly the average corridor length.
+    (Corridors forming a closed loop without any node on them cannot be reached from any node and are dropped.)
+*/
+class MazeGraph
+{
+public:
+    struct Edge
+    {
+        int from, to;                 // Node ids.
+        Direction start_dir, end_dir; // Direction of the first step out of 'from', and of the last step into 'to'.
+        int length;                   // Number of steps.
+        int turns;                    // Number of 90 degree turns within the corridor (not counting turns at the nodes).
+        std::vector<Vec2<int>> cells; // Covered cells in walking order, excluding 'from' but including 'to'.
+    };
+
+    struct Node
+    {
+        Vec2<int> pos;
+        std::vector<int> out_edges; // Edge ids.
+    };
+
+private:
+    static constexpr std::array<Direction, 4> DIRECTIONS = {Direction::Up, Direction::Right, Direction::Down, Direction::Left};
+
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    Grid<int> node_ids; // -1 for cells which aren't nodes.
+    int num_open_cells_ = 0;
+
+    template<typename IsOpen>
+    void walk_corridor(int from, Direction start_dir, IsOpen is_open)
+    {
+        Edge edge {.from = from, .to = -1, .start_dir = start_dir, .end_dir = start_dir, .length = 0, .turns = 0, .cells = {}};
+        Vec2<int> pos = nodes_.at(from).pos;
+        Direction dir = start_dir;
+
+        while (true) {
+            pos += dir_to_vec2<int>(dir);
+            ++edge.length;
+            edge.cells.push_back(pos);
+            if (node_ids.at(pos) != -1) {
+                break;
+            }
+            // A corridor cell has exactly two open neighbours, one of which we came from.
+            const Vec2<int> back = -dir_to_vec2<int>(dir);
+            [[maybe_unused]] bool found = false;
+            for (Direction next_dir : DIRECTIONS) {
+                const Vec2<int> delta = dir_to_vec2<int>(next_dir);
+                if (delta != back && is_open(pos + delta)) {
+                    edge.turns += next_dir != dir ? 1 : 0;
+                    dir = next_dir;
+                    found = true;
+                    break;
+                }
+            }
+            assert(found);
+        }
+        edge.to = node_ids.at(pos);
+        edge.end_dir = dir;
+        nodes_.at(from).out_edges.push_back(std::ssize(edges_));
+        edges_.push_back(std::move(edge));
+    }
+
+public:
+    MazeGraph(const Grid<char>& maze, char wall = '#', const std::vector<Vec2<int>>& keep = {}) : node_ids(maze.width(), maze.height(), -1)
+    {
+        const auto is_open = [&maze, wall](const Vec2<int>& pos) -> bool {
+            const auto tile = maze.try_get(pos);
+            return tile.has_value() && tile.value() != wall;
+        };
+        const auto num_open_neighbours = [&is_open](const Vec2<int>& pos) -> int {
+            int n = 0;
+            for (const Vec2<int>& delta : all_dirs_vec2<int>()) {
+                n += is_open(pos + delta) ? 1 : 0;
+            }
+            return n;
+        };
+
+        maze.foreach([&](const Vec2<int>& pos, char tile) {
+            if (tile == wall) {
+                return;
+            }
+            ++num_open_cells_;
+            if (num_open_neighbours(pos) != 2) {
+                node_ids.at(pos) = std::ssize(nodes_);
+                nodes_.push_back(Node{.pos = pos, .out_edges = {}});
+            }
+        });
+        for (const Vec2<int>& pos : keep) {
+            if (!is_open(pos)) {
+                throw std::invalid_argument("MazeGraph::MazeGraph: Kept position is not an open cell");
+            }
+            if (node_ids.at(pos) == -1) {
+                node_ids.at(pos) = std::ssize(nodes_);
+                nodes_.push_back(Node{.pos = pos, .out_edges = {}});
+            }
+        }
+
+        for (int node_id = 0; node_id < std::ssize(nodes_); ++node_id) {
+            for (Direction dir : DIRECTIONS) {
+                if (is_open(nodes_.at(node_id).pos + dir_to_vec2<int>(dir))) {
+                    walk_corridor(node_id, dir, is_open);
+                }
+            }
+        }
+    }
+
+    const std::vector<Node>& nodes() const {
+        return nodes_;
+    }
+    const std::vector<Edge>& edges() const {
+        return edges_;
+    }
+    const Node& node(int node_id) const {
+        return nodes_.at(node_id);
+    }
+    const Edge& edge(int edge_id) const {
+        return edges_.at(edge_id);
+    }
+
+    std::optional<int> node_id(const Vec2<int>& pos) const
+    {
+        const auto id = node_ids.try_get(pos);
+        if (!id.has_value() || id.value() == -1) {
+            return {};
+        }
+        return id.value();
+    }
+
+    // Number of open cells of the original maze (i.e. the number of nodes an uncompressed search would have).
+    int num_open_cells() const {
+        return num_open_cells_;
+    }
+
+    // Maps a path (or any set) of edges back to the maze tiles it covers (including the start node of every edge), without duplicates.
+    std::vector<Vec2<int>> edge_tiles(const std::vector<int>& edge_ids) const
+    {
+        std::vector<Vec2<int>> tiles;
+        Grid<uint8_t> seen(node_ids.width(), node_ids.height(), 0);
+        const auto add_tile = [&tiles, &seen](const Vec2<int>& pos) {
+            if (!seen.at(pos)) {
+                seen.at(pos) = 1;
+                tiles.push_back(pos);
+            }
+        };
+        for (int edge_id : edge_ids) {
+            const Edge& e = edges_.at(edge_id);
+            add_tile(nodes_.at(e.from).pos);
+            for (const Vec2<int>& pos : e.cells) {
+                add_tile(pos);
+            }
+        }
+        return tiles;
+    }
+};
+
+}
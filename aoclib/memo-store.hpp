@@ -0,0 +1,320 @@
+#pragma once
+
+#include <bit>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include "hash.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AOC_MEMO_STORE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define AOC_MEMO_STORE_MMAP 0
+#endif
+
+/*
+    Persistent memo table: An open-addressed hash table (linear probing) with fixed-size keys and values which lives in a
+    file, so memoised results can be reused by later runs (cf. Memoized::persist in memoize.hpp).
+    File layout (native endianness, so not portable between platforms):
+        Header (64 bytes) | used flags (capacity bytes) | slots (capacity * sizeof(Slot), Slot = {Key, Val})
+    The file is mapped with mmap (MAP_SHARED), so opening it costs nothing up front, lookups only touch the pages they
+    need, and inserts are written back by the OS (flush forces it). Without mmap (neither POSIX nor macOS), the file is
+    read into memory and written back by flush and the destructor.
+    The table grows (by rehashing into the same file) when it is more than half full.
+    It is a cache: If the file doesn't exist or doesn't match (other tag, key/value size or hash function, or a run was
+    killed while the table grew), it is silently replaced by an empty table. Only one process may use a file at a time.
+    Key and Val must be trivially copyable; Key must not have padding (keys are compared byte-wise).
+*/
+
+namespace aocutil
+{
+namespace memo_store_impl
+{
+// The whole file, mapped (or loaded) into memory.
+class MappedFile
+{
+    unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::string path_;
+#if AOC_MEMO_STORE_MMAP
+    int fd = -1;
+
+    void unmap()
+    {
+        if (data_) {
+            munmap(data_, size_);
+            data_ = nullptr;
+        }
+    }
+    void map()
+    {
+        if (size_ == 0) {
+            return;
+        }
+        void* mem = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mem == MAP_FAILED) {
+            throw std::runtime_error("MappedFile map: Cannot map '" + path_ + "'");
+        }
+        data_ = static_cast<unsigned char*>(mem);
+    }
+#else
+    std::vector<unsigned char> buffer;
+#endif
+
+public:
+    // Maps the file at path (an empty file is created if it doesn't exist).
+    explicit MappedFile(std::string path) : path_{std::move(path)}
+    {
+#if AOC_MEMO_STORE_MMAP
+        fd = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            throw std::runtime_error("MappedFile::MappedFile: Cannot open '" + path_ + "'");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        map();
+#else
+        std::ifstream file(path_, std::ios::binary);
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = buffer.data();
+        size_ = buffer.size();
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile()
+    {
+#if AOC_MEMO_STORE_MMAP
+        unmap();
+        if (fd >= 0) {
+            ::close(fd);
+        }
+#else
+        flush();
+#endif
+    }
+
+    unsigned char* data() {
+        return data_;
+    }
+    const unsigned char* data() const {
+        return data_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+
+    // Discards the contents and resizes the file to size bytes (all zero).
+    void reset(std::size_t size)
+    {
+#if AOC_MEMO_STORE_MMAP
+        unmap();
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            throw std::runtime_error("MappedFile reset: Cannot resize '" + path_ + "'");
+        }
+        size_ = size;
+        map();
+#else
+        buffer.assign(size, 0);
+        data_ = buffer.data();
+        size_ = size;
+#endif
+    }
+
+    void flush()
+    {
+#if AOC_MEMO_STORE_MMAP
+        if (data_) {
+            msync(data_, size_, MS_SYNC);
+        }
+#else
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+#endif
+    }
+};
+}
+
+template<typename Key, typename Val, typename Hash = FastHash<Key>>
+class MemoStore
+{
+private:
+    static_assert(std::is_trivially_copyable_v<Key> && std::has_unique_object_representations_v<Key>, "MemoStore: Key must be trivially copyable without padding");
+    static_assert(std::is_trivially_copyable_v<Val>, "MemoStore: Val must be trivially copyable");
+
+    static constexpr char MAGIC[8] = {'A', 'O', 'C', 'M', 'E', 'M', 'O', '1'};
+    static constexpr std::size_t MIN_CAPACITY = 1024;
+
+    struct Slot {
+        Key key;
+        Val val;
+    };
+    struct Header {
+        char magic[8];
+        uint32_t key_size, val_size, slot_size, slot_align;
+        uint64_t tag_hash, hash_check; // hash_check: Hash of a fixed key, detects a changed hash function.
+        uint64_t capacity, size;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(Header) == 64 && alignof(Slot) <= 16); // The slots start at a multiple of 64 bytes into the file (or a new-allocated buffer).
+
+    [[no_unique_address]] Hash hasher;
+    memo_store_impl::MappedFile file;
+    uint64_t tag_hash;
+
+    static uint64_t hash_check_of(const Hash& hash)
+    {
+        Key key;
+        std::memset(&key, 0x5a, sizeof(key));
+        return hash(key);
+    }
+
+    static std::size_t file_size(std::size_t capacity) {
+        return sizeof(Header) + capacity + capacity * sizeof(Slot);
+    }
+
+    Header& header() {
+        return *reinterpret_cast<Header*>(file.data());
+    }
+    const Header& header() const {
+        return *reinterpret_cast<const Header*>(file.data());
+    }
+    const unsigned char* used() const {
+        return file.data() + sizeof(Header);
+    }
+    unsigned char* used() {
+        return file.data() + sizeof(Header);
+    }
+    // The capacity (a power of two >= 64) keeps the slots aligned.
+    Slot* slots() const {
+        return reinterpret_cast<Slot*>(const_cast<unsigned char*>(file.data()) + sizeof(Header) + header().capacity);
+    }
+
+    bool valid() const
+    {
+        if (file.size() < sizeof(Header)) {
+            return false;
+        }
+        const Header& h = header();
+        return std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.key_size == sizeof(Key) && h.val_size == sizeof(Val)
+            && h.slot_size == sizeof(Slot) && h.slot_align == alignof(Slot) && h.tag_hash == tag_hash && h.hash_check == hash_check_of(hasher)
+            && std::has_single_bit(h.capacity) && h.capacity >= MIN_CAPACITY && file.size() == file_size(h.capacity) && h.size <= h.capacity / 2;
+    }
+
+    // Replaces the file's contents by an empty table.
+    void reset(std::size_t capacity)
+    {
+        file.reset(file_size(capacity));
+        Header& h = header();
+        h.key_size = sizeof(Key);
+        h.val_size = sizeof(Val);
+        h.slot_size = sizeof(Slot);
+        h.slot_align = alignof(Slot);
+        h.tag_hash = tag_hash;
+        h.hash_check = hash_check_of(hasher);
+        h.capacity = capacity;
+        h.size = 0;
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC)); // Last, so an interrupted reset leaves an invalid file.
+    }
+
+    // Slot index of key, or of the empty slot where it would be inserted.
+    std::size_t probe(const Key& key) const
+    {
+        const std::size_t mask = header().capacity - 1;
+        std::size_t idx = static_cast<std::size_t>(hasher(key)) & mask;
+        while (used()[idx] && std::memcmp(&slots()[idx].key, &key, sizeof(Key)) != 0) {
+            idx = (idx + 1) & mask;
+        }
+        return idx;
+    }
+
+    void grow()
+    {
+        std::vector<Slot> entries;
+        entries.reserve(header().size);
+        for (std::size_t i = 0; i < header().capacity; ++i) {
+            if (used()[i]) {
+                entries.push_back(slots()[i]);
+            }
+        }
+        reset(header().capacity * 2);
+        for (const Slot& entry : entries) {
+            const std::size_t idx = probe(entry.key);
+            slots()[idx] = entry;
+            used()[idx] = 1;
+        }
+        header().size = entries.size();
+    }
+
+public:
+    // tag identifies the memoised function (e.g. "day-11 len_after_blinks"); a file written for another tag is discarded.
+    MemoStore(std::string path, std::string_view tag, std::size_t min_capacity = 0)
+        : file{std::move(path)}, tag_hash{FastHash<std::string_view>{}(tag)}
+    {
+        if (!valid()) {
+            reset(std::bit_ceil(std::max(MIN_CAPACITY, min_capacity * 2)));
+        }
+    }
+    MemoStore(const MemoStore&) = delete;
+    MemoStore& operator=(const MemoStore&) = delete;
+
+    std::size_t size() const {
+        return header().size;
+    }
+    std::size_t capacity() const {
+        return header().capacity / 2;
+    }
+
+    // Pointer to the value of key (or nullptr), invalidated by insert.
+    const Val* find(const Key& key) const
+    {
+        const std::size_t idx = probe(key);
+        return used()[idx] ? &slots()[idx].val : nullptr;
+    }
+
+    // Returns false (and keeps the stored value) if key is already stored.
+    bool insert(const Key& key, const Val& val)
+    {
+        if (header().size + 1 > header().capacity / 2) {
+            grow();
+        }
+        const std::size_t idx = probe(key);
+        if (used()[idx]) {
+            return false;
+        }
+        slots()[idx] = Slot{key, val};
+        used()[idx] = 1; // After the slot, and the size last, so a killed run leaves at most an uncounted entry behind.
+        ++header().size;
+        return true;
+    }
+
+    // Calls fn(key, val) for every stored entry.
+    template<typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        for (std::size_t i = 0; i < header().capacity; ++i) {
+            if (used()[i]) {
+                fn(slots()[i].key, slots()[i].val);
+            }
+        }
+    }
+
+    // Writes the table to disk now (otherwise, the OS does it eventually; without mmap, the destructor does it).
+    void flush()
+    {
+        file.flush();
+    }
+};
+
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <ostream>
+#include <iomanip>
+#include <type_traits>
+#include "flat-hash.hpp"
+#include "lru-cache.hpp"
+#include "sharded-lru-cache.hpp"
+#include "memo-store.hpp"
+
+/*
+    Memoisation of recursive functions without threading a cache through every call:
+
+        auto fib = aocutil::memoize<int64_t(int)>([](auto& self, int n) -> int64_t {
+            return n < 2 ? n : self(n - 1) + self(n - 2);
+        });
+        fib(80);
+
+    The function gets the memoised function itself (self) as its first parameter, so its recursive calls are memoised as well.
+    The arguments are packed into one key: Into a uint64_t if they are integers (or other types without padding) with at
+    most 8 bytes in total, into a byte array if they are larger, and into a std::tuple otherwise (which needs FastHash
+    for every argument type). The cache backend is chosen by MemoBackend:
+    - Flat: Unbounded FlatMap (the default, the fastest if everything fits into memory).
+    - LRU: LRUCache with a fixed capacity (memoize<Sig, MemoBackend::LRU>(fn, capacity)).
+    - Sharded: ShardedLRUCache with a fixed capacity, the only thread-safe backend (e.g. for parallel_transform_reduce
+      workers); fn is called without holding a lock, so two threads might compute the same value.
+    Values are returned by copy: A reference into the cache would be invalidated by the recursive calls.
+    persist(path, tag) backs any of them with a MemoStore file (if the key and the value are trivially copyable): Misses
+    are looked up in the file before fn is called, and new values are written to it, so later runs start warm.
+*/
+
+namespace aocutil
+{
+enum class MemoBackend {Flat, LRU, Sharded};
+
+struct MemoStats
+{
+    uint64_t hits = 0, misses = 0;
+    uint64_t stored = 0; // Misses answered by the persistent store (cf. Memoized::persist).
+    std::size_t size = 0; // Cached values.
+
+    double hit_rate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const MemoStats& stats)
+    {
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        os << "hits: " << stats.hits << ", misses: " << stats.misses << " (hit rate: " << std::fixed << std::setprecision(3)
+           << stats.hit_rate() << "), from store: " << stats.stored << ", size: " << stats.size << "\n";
+        os.flags(flags);
+        os.precision(precision);
+        return os;
+    }
+};
+
+namespace memo_impl
+{
+template<typename... Args>
+constexpr bool packable = ((std::is_trivially_copyable_v<Args> && std::has_unique_object_representations_v<Args>) && ...);
+
+template<typename... Args>
+constexpr std::size_t packed_size = (sizeof(Args) + ... + 0);
+
+template<typename... Args>
+struct KeyOf {
+    using type = std::tuple<Args...>;
+};
+template<typename... Args> requires packable<Args...> && (packed_size<Args...> <= sizeof(uint64_t))
+struct KeyOf<Args...> {
+    using type = uint64_t;
+};
+template<typename... Args> requires packable<Args...> && (packed_size<Args...> > sizeof(uint64_t))
+struct KeyOf<Args...> {
+    using type = std::array<unsigned char, packed_size<Args...>>;
+};
+
+template<typename... Args>
+using Key = typename KeyOf<std::remove_cvref_t<Args>...>::type;
+
+template<typename... Args>
+Key<Args...> pack(const Args&... args)
+{
+    if constexpr (std::is_same_v<Key<Args...>, std::tuple<std::remove_cvref_t<Args>...>>) {
+        return Key<Args...>{args...};
+    } else {
+        Key<Args...> key{};
+        unsigned char* dst = reinterpret_cast<unsigned char*>(&key);
+        ((std::memcpy(dst, &args, sizeof(args)), dst += sizeof(args)), ...);
+        return key;
+    }
+}
+
+template<typename Key, typename Val>
+struct Persisted {
+    MemoStore<Key, Val> store;
+    std::mutex mutex; // For the Sharded backend.
+    uint64_t hits = 0;
+
+    Persisted(std::string path, std::string_view tag) : store(std::move(path), tag) {}
+};
+struct NotPersistable {};
+
+template<MemoBackend backend, typename Key, typename Val>
+struct CacheOf {
+    using type = FlatMap<Key, Val>;
+};
+template<typename Key, typename Val>
+struct CacheOf<MemoBackend::LRU, Key, Val> {
+    using type = LRUCache<Key, Val>;
+};
+template<typename Key, typename Val>
+struct CacheOf<MemoBackend::Sharded, Key, Val> {
+    using type = ShardedLRUCache<Key, Val>;
+};
+}
+
+template<typename Sig, MemoBackend backend, typename Fn>
+class Memoized;
+
+template<typename Ret, typename... Args, MemoBackend backend, typename Fn>
+class Memoized<Ret(Args...), backend, Fn>
+{
+private:
+    using Key = memo_impl::Key<Args...>;
+    static constexpr bool persistable = std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Ret>;
+    using Persisted = std::conditional_t<persistable, memo_impl::Persisted<Key, Ret>, memo_impl::NotPersistable>;
+
+    Fn fn;
+    typename memo_impl::CacheOf<backend, Key, Ret>::type cache;
+    uint64_t hits = 0, misses = 0; // The sharded cache counts its own (thread-safe).
+    std::unique_ptr<Persisted> persisted;
+
+    // Value of a key which is not cached: From the store if it has it, otherwise computed (and stored).
+    Ret compute(const Key& key, const std::remove_cvref_t<Args>&... args)
+    {
+        if constexpr (persistable) {
+            if (persisted) {
+                {
+                    std::lock_guard guard{persisted->mutex};
+                    if (const Ret* stored = persisted->store.find(key)) {
+                        ++persisted->hits;
+                        return *stored;
+                    }
+                }
+                Ret val = fn(*this, args...);
+                std::lock_guard guard{persisted->mutex};
+                persisted->store.insert(key, val);
+                return val;
+            }
+        }
+        return fn(*this, args...);
+    }
+
+public:
+    // cache_args: The capacity for LRU, the capacity and optionally the number of shards for Sharded.
+    template<typename F, typename... CacheArgs>
+    explicit Memoized(F&& f, CacheArgs&&... cache_args) : fn{std::forward<F>(f)}, cache(std::forward<CacheArgs>(cache_args)...) {}
+
+    Ret operator()(const std::remove_cvref_t<Args>&... args)
+    {
+        const Key key = memo_impl::pack(args...);
+        if constexpr (backend == MemoBackend::Flat) {
+            if (const auto it = cache.find(key); it != cache.end()) {
+                ++hits;
+                return it->second;
+            }
+            ++misses;
+            Ret val = compute(key, args...);
+            cache.try_emplace(key, val); // Not it from above: The recursive calls invalidate it.
+            return val;
+        } else if constexpr (backend == MemoBackend::LRU) {
+            bool hit = true;
+            Ret val = cache.get_or_compute(key, [&]() { hit = false; return compute(key, args...); });
+            ++(hit ? hits : misses);
+            return val;
+        } else {
+            return cache.get_or_compute(key, [&]() { return compute(key, args...); });
+        }
+    }
+
+    /*
+        Backs the cache with the MemoStore file at path (created if necessary). tag identifies the function: A file written
+        for another tag (or with other key/value types) is replaced. Not thread-safe, call it before using the function.
+    */
+    void persist(std::string path, std::string_view tag) requires persistable
+    {
+        persisted = std::make_unique<Persisted>(std::move(path), tag);
+    }
+
+    // Writes the store to disk now (cf. MemoStore::flush).
+    void flush() requires persistable
+    {
+        if (persisted) {
+            std::lock_guard guard{persisted->mutex};
+            persisted->store.flush();
+        }
+    }
+
+    // Clears the cache, not the store (not thread-safe for the Sharded backend either).
+    void clear()
+    {
+        cache.clear();
+        reset_stats();
+    }
+
+    std::size_t size() const
+    {
+        return cache.size();
+    }
+
+    MemoStats stats() const
+    {
+        MemoStats stats{.hits = hits, .misses = misses, .size = cache.size()};
+        if constexpr (backend == MemoBackend::Sharded) {
+            const ShardStats shard_stats = cache.stats();
+            stats.hits = shard_stats.hits;
+            stats.misses = shard_stats.misses;
+        }
+        if constexpr (persistable) {
+            if (persisted) {
+                std::lock_guard guard{persisted->mutex};
+                stats.stored = persisted->hits;
+            }
+        }
+        return stats;
+    }
+
+    void reset_stats()
+    {
+        if constexpr (backend == MemoBackend::Sharded) {
+            cache.reset_stats();
+        }
+        hits = misses = 0;
+        if constexpr (persistable) {
+            if (persisted) {
+                persisted->hits = 0;
+            }
+        }
+    }
+};
+
+// Sig: The signature of fn without its first (self) parameter, e.g. int64_t(int64_t, int); cf. the comment at the top.
+template<typename Sig, MemoBackend backend = MemoBackend::Flat, typename Fn, typename... CacheArgs>
+Memoized<Sig, backend, std::decay_t<Fn>> memoize(Fn&& fn, CacheArgs&&... cache_args)
+{
+    return Memoized<Sig, backend, std::decay_t<Fn>>(std::forward<Fn>(fn), std::forward<CacheArgs>(cache_args)...);
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cassert>
+#include <optional>
+#include "vec.hpp"
+
+namespace aocutil
+{
+/*
+    Grid with NumChannels fixed values per cell (e.g. one score per direction), all stored in a single contiguous
+    allocation at index cell * NumChannels + channel. Replaces per-cell containers (like a Grid of structs holding
+    std::vectors), which means no allocations per cell and no pointer chasing on lookups.
+    ChannelId can be an enum naming the channels, which is then used for the channel accessors.
+*/
+template<typename ElemType, int NumChannels, typename ChannelId = int>
+class MultiGrid
+{
+    static_assert(NumChannels > 0);
+
+    std::vector<ElemType> data;
+    int width_ = 0, height_ = 0;
+
+    int calc_idx(int x, int y, ChannelId channel) const {
+        return (x + y * width_) * NumChannels + static_cast<int>(channel);
+    }
+
+    void check_access(int x, int y, ChannelId channel, const char* msg) const
+    {
+        if (!pos_on_grid(x, y) || static_cast<int>(channel) < 0 || static_cast<int>(channel) >= NumChannels) {
+            throw std::out_of_range(msg);
+        }
+    }
+
+public:
+    typedef ElemType value_type;
+    static constexpr int num_channels = NumChannels;
+
+    MultiGrid() = default;
+
+    MultiGrid(int width, int height, const ElemType& init_val) : width_{width}, height_{height}
+    {
+        if (height < 0 || width < 0) {
+            throw std::invalid_argument("MultiGrid::MultiGrid: height or width < 0");
+        }
+        data = std::vector<ElemType>(width * height * NumChannels, init_val);
+    }
+
+    ElemType& at(int x, int y, ChannelId channel)
+    {
+        check_access(x, y, channel, "MultiGrid at: invalid position or channel");
+        return data[calc_idx(x, y, channel)];
+    }
+    ElemType& at(const Vec2<int>& pos, ChannelId channel) {
+        return at(pos.x, pos.y, channel);
+    }
+
+    const ElemType& at(int x, int y, ChannelId channel) const
+    {
+        check_access(x, y, channel, "MultiGrid at: invalid position or channel");
+        return data[calc_idx(x, y, channel)];
+    }
+    const ElemType& at(const Vec2<int>& pos, ChannelId channel) const {
+        return at(pos.x, pos.y, channel);
+    }
+
+    std::optional<ElemType> try_get(const Vec2<int>& pos, ChannelId channel) const
+    {
+        if (!pos_on_grid(pos)) {
+            return {};
+        }
+        return at(pos, channel);
+    }
+
+    // All channels of one cell (contiguous).
+    std::span<ElemType, NumChannels> channels(const Vec2<int>& pos)
+    {
+        check_access(pos.x, pos.y, ChannelId{}, "MultiGrid channels: invalid position");
+        return std::span<ElemType, NumChannels>(data.data() + calc_idx(pos.x, pos.y, ChannelId{}), NumChannels);
+    }
+    std::span<const ElemType, NumChannels> channels(const Vec2<int>& pos) const
+    {
+        check_access(pos.x, pos.y, ChannelId{}, "MultiGrid channels: invalid position");
+        return std::span<const ElemType, NumChannels>(data.data() + calc_idx(pos.x, pos.y, ChannelId{}), NumChannels);
+    }
+
+    void fill(const ElemType& val) {
+        std::fill(data.begin(), data.end(), val);
+    }
+
+    bool pos_on_grid(int x, int y) const {
+        return x >= 0 && x < width_ && y >= 0 && y < height_;
+    }
+    bool pos_on_grid(const Vec2<int>& pos) const {
+        return pos_on_grid(pos.x, pos.y);
+    }
+
+    int height() const {
+        return height_;
+    }
+    int width() const {
+        return width_;
+    }
+};
+
+}
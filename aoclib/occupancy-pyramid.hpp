@@ -0,0 +1,290 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <optional>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include "grid.hpp"
+#include "vec.hpp"
+
+namespace aocutil
+{
+/*
+    Occupancy "mipmap" over a grid: Level 0 stores whether each cell is occupied, and every level k > 0 stores the number
+    of occupied cells per block of BLOCK_SIZE^k x BLOCK_SIZE^k cells. Ray casts and run finding skip whole empty (or full)
+    blocks instead of visiting every cell, and set() only updates one count per level.
+*/
+class OccupancyPyramid
+{
+public:
+    static constexpr int BLOCK_SIZE = 8;
+
+private:
+    struct Level
+    {
+        int block_size; // In cells.
+        int width, height; // In blocks.
+        std::vector<int32_t> counts;
+    };
+
+    int width_ = 0, height_ = 0;
+    std::vector<uint8_t> cells;
+    std::vector<Level> levels; // levels[0] is level 1 (the cells themselves are level 0).
+
+    const Level& level(int lvl) const
+    {
+        assert(lvl >= 1 && lvl <= std::ssize(levels));
+        return levels[lvl - 1];
+    }
+
+    int32_t block_count(int lvl, const Vec2<int>& pos) const
+    {
+        const Level& l = level(lvl);
+        return l.counts[(pos.x / l.block_size) + (pos.y / l.block_size) * l.width];
+    }
+
+    // Number of cells of the block containing pos which are actually on the grid (blocks at the right/bottom edges may be cut off).
+    int32_t block_area(int lvl, const Vec2<int>& pos) const
+    {
+        const int size = level(lvl).block_size;
+        const int x0 = (pos.x / size) * size, y0 = (pos.y / size) * size;
+        return std::min(size, width_ - x0) * std::min(size, height_ - y0);
+    }
+
+    // Returns the first position after the block (of level lvl) containing pos in direction dir.
+    Vec2<int> skip_block(int lvl, Vec2<int> pos, Direction dir) const
+    {
+        const int size = level(lvl).block_size;
+        switch (dir) {
+            case Direction::Right:
+                pos.x = (pos.x / size + 1) * size;
+                break;
+            case Direction::Left:
+                pos.x = (pos.x / size) * size - 1;
+                break;
+            case Direction::Down:
+                pos.y = (pos.y / size + 1) * size;
+                break;
+            case Direction::Up:
+                pos.y = (pos.y / size) * size - 1;
+                break;
+            default:
+                throw std::invalid_argument("OccupancyPyramid: Invalid direction");
+        }
+        return pos;
+    }
+
+    // Highest level whose block containing pos is completely occupied (or completely empty if occupied is false), or 0 if there is none.
+    int highest_uniform_level(const Vec2<int>& pos, bool occupied) const
+    {
+        int lvl = 0;
+        while (lvl < std::ssize(levels)) {
+            const int32_t cnt = block_count(lvl + 1, pos);
+            if ((!occupied && cnt != 0) || (occupied && cnt != block_area(lvl + 1, pos))) {
+                break;
+            }
+            ++lvl;
+        }
+        return lvl;
+    }
+
+    // Walks from pos (inclusive, or exclusive if skip_pos) in direction dir until a cell with the given occupancy is found.
+    std::optional<Vec2<int>> find_from(Vec2<int> pos, Direction dir, bool occupied, bool skip_pos = false) const
+    {
+        if (!pos_on_grid(pos)) {
+            return {};
+        }
+        // Cells from pos (inclusive) to the edge of the grid, counted down instead of bounds-checking the stepped position
+        // (the signed checks made GCC warn with -Wstrict-overflow wherever this is inlined).
+        std::size_t remaining = 0;
+        switch (dir) {
+            case Direction::Right:
+                remaining = static_cast<std::size_t>(width_ - pos.x);
+                break;
+            case Direction::Left:
+                remaining = static_cast<std::size_t>(pos.x) + 1;
+                break;
+            case Direction::Down:
+                remaining = static_cast<std::size_t>(height_ - pos.y);
+                break;
+            case Direction::Up:
+                remaining = static_cast<std::size_t>(pos.y) + 1;
+                break;
+            default:
+                throw std::invalid_argument("OccupancyPyramid: Invalid direction");
+        }
+        const Vec2<int> delta = dir_to_vec2<int>(dir);
+        if (skip_pos) {
+            if (remaining == 1) {
+                return {};
+            }
+            --remaining;
+            pos += delta;
+        }
+        while (true) {
+            if (is_occupied(pos) == occupied) {
+                return pos;
+            }
+            const int lvl = highest_uniform_level(pos, !occupied);
+            const Vec2<int> next = lvl == 0 ? pos + delta : skip_block(lvl, pos, dir);
+            const std::size_t steps = static_cast<std::size_t>(std::abs(next.x - pos.x) + std::abs(next.y - pos.y));
+            if (steps >= remaining) {
+                return {};
+            }
+            remaining -= steps;
+            pos = next;
+        }
+    }
+
+public:
+    OccupancyPyramid() = default;
+
+    OccupancyPyramid(int width, int height) : width_{width}, height_{height}
+    {
+        if (height < 0 || width < 0) {
+            throw std::invalid_argument("OccupancyPyramid::OccupancyPyramid: height or width < 0");
+        }
+        cells = std::vector<uint8_t>(width * height, 0);
+        for (int size = BLOCK_SIZE; ; size *= BLOCK_SIZE) {
+            const int w = width / size + (width % size != 0), h = height / size + (height % size != 0);
+            levels.push_back(Level{.block_size = size, .width = w, .height = h, .counts = std::vector<int32_t>(w * h, 0)});
+            if (w <= 1 && h <= 1) {
+                break;
+            }
+        }
+    }
+
+    template<typename ElemType, typename Predicate>
+    OccupancyPyramid(const Grid<ElemType>& grid, Predicate is_occupied) : OccupancyPyramid(grid.width(), grid.height())
+    {
+        grid.foreach([this, &is_occupied](const Vec2<int>& pos, const ElemType& elem) {
+            if (is_occupied(elem)) {
+                set(pos, true);
+            }
+        });
+    }
+
+    // O(number of levels).
+    void set(const Vec2<int>& pos, bool occupied)
+    {
+        if (!pos_on_grid(pos)) {
+            throw std::out_of_range("OccupancyPyramid set: invalid position");
+        }
+        uint8_t& cell = cells[pos.x + pos.y * width_];
+        if (cell == (occupied ? 1 : 0)) {
+            return;
+        }
+        cell = occupied ? 1 : 0;
+        for (Level& l : levels) {
+            l.counts[(pos.x / l.block_size) + (pos.y / l.block_size) * l.width] += occupied ? 1 : -1;
+        }
+    }
+
+    void clear()
+    {
+        std::fill(cells.begin(), cells.end(), 0);
+        for (Level& l : levels) {
+            std::fill(l.counts.begin(), l.counts.end(), 0);
+        }
+    }
+
+    bool is_occupied(const Vec2<int>& pos) const
+    {
+        assert(pos_on_grid(pos));
+        return cells[pos.x + pos.y * width_];
+    }
+
+    int count() const {
+        return levels.empty() ? 0 : levels.back().counts.at(0);
+    }
+
+    // First occupied cell strictly after pos (on the grid) in direction dir (skipping empty blocks), or {} if there is none.
+    std::optional<Vec2<int>> ray_cast(const Vec2<int>& pos, Direction dir) const {
+        return find_from(pos, dir, true, true);
+    }
+
+    // First occupied (or empty, if occupied is false) cell in row y at or after column x.
+    std::optional<int> next_in_row(int x, int y, bool occupied = true) const
+    {
+        const auto found = find_from(Vec2<int>{x, y}, Direction::Right, occupied);
+        if (!found.has_value()) {
+            return {};
+        }
+        return found->x;
+    }
+
+    // Length of the longest run of consecutive occupied cells in row y.
+    int longest_run_in_row(int y) const
+    {
+        if (y < 0 || y >= height_) {
+            throw std::out_of_range("OccupancyPyramid longest_run_in_row: invalid row");
+        }
+        int longest = 0;
+        for (int x = 0; x < width_;) {
+            const auto run_start = next_in_row(x, y, true);
+            if (!run_start.has_value()) {
+                break;
+            }
+            const int run_end = next_in_row(run_start.value(), y, false).value_or(width_);
+            longest = std::max(longest, run_end - run_start.value());
+            x = run_end;
+        }
+        return longest;
+    }
+
+    /*
+        Start of the first run of at least min_length occupied cells in row y, or {} if there is none.
+        A run of at least 2 * size - 1 cells covers a whole aligned segment of size cells of the row, so it can only pass through
+        blocks (of the coarsest level with such a size) which contain at least size occupied cells; all other blocks are skipped
+        with a single lookup, even if they aren't empty.
+    */
+    std::optional<int> find_run_in_row(int y, int min_length) const
+    {
+        if (y < 0 || y >= height_) {
+            throw std::out_of_range("OccupancyPyramid find_run_in_row: invalid row");
+        }
+        if (min_length <= 0) {
+            return 0;
+        }
+        int lvl = 0;
+        while (lvl < std::ssize(levels) && 2 * int64_t(level(lvl + 1).block_size) <= int64_t(min_length) + 1) { // 2 * size - 1 <= min_length
+            ++lvl;
+        }
+
+        const int size = lvl == 0 ? 1 : level(lvl).block_size;
+        int checked_until = 0; // End of the last measured run (which is an empty cell or the end of the row).
+        for (int x0 = 0; x0 + size <= width_; x0 += size) {
+            if (x0 < checked_until || (lvl > 0 && block_count(lvl, Vec2<int>{x0, y}) < size)) {
+                continue;
+            }
+            const int segment_end = next_in_row(x0, y, false).value_or(width_);
+            if (segment_end < x0 + size) {
+                continue;
+            }
+            int run_start = x0;
+            while (run_start > 0 && is_occupied(Vec2<int>{run_start - 1, y})) {
+                --run_start;
+            }
+            if (segment_end - run_start >= min_length) {
+                return run_start;
+            }
+            checked_until = segment_end;
+        }
+        return {};
+    }
+
+    bool pos_on_grid(const Vec2<int>& pos) const {
+        return pos.x >= 0 && pos.x < width_ && pos.y >= 0 && pos.y < height_;
+    }
+
+    int height() const {
+        return height_;
+    }
+    int width() const {
+        return width_;
+    }
+};
+
+}
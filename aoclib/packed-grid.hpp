@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <optional>
+#include "grid.hpp"
+
+namespace aocutil
+{
+/*
+    Grid<char> for inputs with only a handful of distinct symbols (e.g. ".#^" or ".#O@[]"): The alphabet is mapped to
+    2-bit (up to 4 symbols) or 4-bit (up to 16 symbols) codes which are stored packed in 64-bit words, i.e. 32 or 16 cells per word.
+    Every row starts at a word boundary, so row operations like count_in_row work on whole words (SWAR) at a time.
+*/
+class PackedGrid
+{
+    using word_t = uint64_t;
+    static constexpr int WORD_BITS = 64;
+
+    std::string alphabet_; // code -> symbol
+    std::array<int8_t, 256> codes; // symbol -> code (-1 if the symbol is not in the alphabet)
+    int bits = 2, cells_per_word = 32, words_per_row = 0;
+    word_t code_mask = 0b11;
+    int width_ = 0, height_ = 0;
+    std::vector<word_t> words;
+
+    uint8_t code_of(char sym) const
+    {
+        const int8_t code = codes[static_cast<unsigned char>(sym)];
+        if (code < 0) {
+            throw std::invalid_argument(std::string{"PackedGrid: Symbol '"} + sym + "' not in alphabet");
+        }
+        return code;
+    }
+
+    word_t& word_at(int x, int y) {
+        return words[y * words_per_row + x / cells_per_word];
+    }
+    word_t word_at(int x, int y) const {
+        return words[y * words_per_row + x / cells_per_word];
+    }
+    int shift_of(int x) const {
+        return (x % cells_per_word) * bits;
+    }
+
+    // The code repeated in every field of a word.
+    word_t broadcast(uint8_t code) const
+    {
+        word_t pattern = 0;
+        for (int i = 0; i < cells_per_word; ++i) {
+            pattern |= word_t{code} << (i * bits);
+        }
+        return pattern;
+    }
+
+    // Has the lowest bit of every field set for which the field equals the corresponding field of pattern.
+    word_t match_fields(word_t w, word_t pattern) const
+    {
+        word_t eq = ~(w ^ pattern); // Fields which are equal are all ones.
+        if (bits == 2) {
+            return eq & (eq >> 1) & 0x5555'5555'5555'5555;
+        }
+        eq &= eq >> 1;
+        return eq & (eq >> 2) & 0x1111'1111'1111'1111;
+    }
+
+public:
+    PackedGrid() = default;
+
+    // If alphabet is empty, it is made up of the distinct symbols of the grid.
+    PackedGrid(const Grid<char>& grid, std::string_view alphabet = "") : width_{grid.width()}, height_{grid.height()}
+    {
+        if (alphabet.empty()) {
+            std::array<bool, 256> seen {};
+            for (char c : grid.elems()) {
+                seen[static_cast<unsigned char>(c)] = true;
+            }
+            for (int c = 0; c < 256; ++c) {
+                if (seen[c]) {
+                    alphabet_.push_back(static_cast<char>(c));
+                }
+            }
+        } else {
+            alphabet_ = alphabet;
+        }
+        if (alphabet_.size() > 16) {
+            throw std::invalid_argument("PackedGrid::PackedGrid: More than 16 symbols");
+        }
+
+        codes.fill(-1);
+        for (int code = 0; code < std::ssize(alphabet_); ++code) {
+            codes[static_cast<unsigned char>(alphabet_[code])] = code;
+        }
+        bits = alphabet_.size() <= 4 ? 2 : 4;
+        cells_per_word = WORD_BITS / bits;
+        code_mask = (word_t{1} << bits) - 1;
+        words_per_row = (width_ + cells_per_word - 1) / cells_per_word;
+        words = std::vector<word_t>(words_per_row * height_, 0);
+
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                word_at(x, y) |= word_t{code_of(grid[Vec2<int>{x, y}])} << shift_of(x);
+            }
+        }
+    }
+
+    uint8_t get_code(int x, int y) const
+    {
+        if (!pos_on_grid(x, y)) {
+            throw std::out_of_range("PackedGrid get_code: invalid position");
+        }
+        return (word_at(x, y) >> shift_of(x)) & code_mask;
+    }
+
+    char get(int x, int y) const {
+        return alphabet_[get_code(x, y)];
+    }
+    char get(const Vec2<int>& pos) const {
+        return get(pos.x, pos.y);
+    }
+
+    std::optional<char> try_get(const Vec2<int>& pos) const
+    {
+        if (!pos_on_grid(pos)) {
+            return {};
+        }
+        return get(pos);
+    }
+
+    void set(int x, int y, char sym)
+    {
+        if (!pos_on_grid(x, y)) {
+            throw std::out_of_range("PackedGrid set: invalid position");
+        }
+        word_t& w = word_at(x, y);
+        w = (w & ~(code_mask << shift_of(x))) | (word_t{code_of(sym)} << shift_of(x));
+    }
+    void set(const Vec2<int>& pos, char sym) {
+        set(pos.x, pos.y, sym);
+    }
+
+    // Counts the cells equal to sym in row y, a whole word (16 or 32 cells) at a time.
+    int count_in_row(int y, char sym) const
+    {
+        if (y < 0 || y >= height_) {
+            throw std::out_of_range("PackedGrid count_in_row: invalid row");
+        }
+        const int8_t code = codes[static_cast<unsigned char>(sym)];
+        if (code < 0) {
+            return 0;
+        }
+        const word_t pattern = broadcast(code);
+        int count = 0;
+        for (int i = 0; i < words_per_row; ++i) {
+            word_t matches = match_fields(words[y * words_per_row + i], pattern);
+            if (i == words_per_row - 1 && width_ % cells_per_word != 0) { // Ignore the padding after the last cell of the row.
+                matches &= (word_t{1} << ((width_ % cells_per_word) * bits)) - 1;
+            }
+            count += std::popcount(matches);
+        }
+        return count;
+    }
+
+    int count(char sym) const
+    {
+        int total = 0;
+        for (int y = 0; y < height_; ++y) {
+            total += count_in_row(y, sym);
+        }
+        return total;
+    }
+
+    std::string row(int y) const
+    {
+        if (y < 0 || y >= height_) {
+            throw std::out_of_range("PackedGrid row: invalid row");
+        }
+        std::string r(width_, '\0');
+        for (int x = 0; x < width_; ++x) {
+            r[x] = alphabet_[(word_at(x, y) >> shift_of(x)) & code_mask];
+        }
+        return r;
+    }
+
+    Grid<char> to_grid() const
+    {
+        Grid<char> grid;
+        for (int y = 0; y < height_; ++y) {
+            grid.push_row(row(y));
+        }
+        return grid;
+    }
+
+    std::vector<Vec2<int>> find_elem_positions(char sym) const
+    {
+        std::vector<Vec2<int>> positions;
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                if (get(x, y) == sym) {
+                    positions.push_back(Vec2<int>{x, y});
+                }
+            }
+        }
+        return positions;
+    }
+
+    const std::string& alphabet() const {
+        return alphabet_;
+    }
+    int bits_per_cell() const {
+        return bits;
+    }
+
+    bool pos_on_grid(int x, int y) const {
+        return x >= 0 && x < width_ && y >= 0 && y < height_;
+    }
+    bool pos_on_grid(const Vec2<int>& pos) const {
+        return pos_on_grid(pos.x, pos.y);
+    }
+
+    int height() const {
+        return height_;
+    }
+    int width() const {
+        return width_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const PackedGrid& g)
+    {
+        for (int y = 0; y < g.height(); ++y) {
+            os << g.row(y) << "\n";
+        }
+        return os;
+    }
+};
+
+}
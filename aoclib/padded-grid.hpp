@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cassert>
+#include "grid.hpp"
+
+namespace aocutil
+{
+/*
+    Grid surrounded by a one cell wide border of a fixed value, stored row-major with a stride of width + 2.
+    Because of the border, the neighbours of every inner cell are just idx + offset (with the precomputed signed
+    offsets ±1, ±stride, ±stride±1), so traversals can work entirely on int32_t indices without any bounds checks,
+    and only convert to Vec2 (pos/idx) at the edges.
+    (The border value should be something the traversal never accepts, e.g. '#' for mazes or -1 for height maps.)
+*/
+template<typename ElemType>
+class PaddedGrid
+{
+public:
+    using idx_t = int32_t;
+
+private:
+    std::vector<ElemType> data;
+    int width_ = 0, height_ = 0;
+    idx_t stride = 0;
+    std::array<idx_t, 4> offsets4_;
+    std::array<idx_t, 8> offsets8_;
+
+    void init_offsets()
+    {
+        // Same order as all_dirs_vec2() and all_dirs_plus_diagonals_vec2(): right, left, up, down, up-right, up-left, down-right, down-left.
+        const auto dirs = all_dirs_plus_diagonals_vec2<idx_t>();
+        for (std::size_t i = 0; i < dirs.size(); ++i) {
+            offsets8_[i] = dirs[i].x + dirs[i].y * stride;
+            if (i < offsets4_.size()) {
+                offsets4_[i] = offsets8_[i];
+            }
+        }
+    }
+
+public:
+    typedef ElemType value_type;
+
+    PaddedGrid() = default;
+
+    PaddedGrid(const Grid<ElemType>& grid, const ElemType& border_val) : width_{grid.width()}, height_{grid.height()}, stride{grid.width() + 2}
+    {
+        data = std::vector<ElemType>((width_ + 2) * (height_ + 2), border_val);
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                data[idx(x, y)] = grid[Vec2<int>{x, y}];
+            }
+        }
+        init_offsets();
+    }
+
+    PaddedGrid(int width, int height, const ElemType& init_val, const ElemType& border_val) : width_{width}, height_{height}, stride{width + 2}
+    {
+        if (height < 0 || width < 0) {
+            throw std::invalid_argument("PaddedGrid::PaddedGrid: height or width < 0");
+        }
+        data = std::vector<ElemType>((width_ + 2) * (height_ + 2), border_val);
+        for (int y = 0; y < height_; ++y) {
+            std::fill_n(data.begin() + idx(0, y), width_, init_val);
+        }
+        init_offsets();
+    }
+
+    // Positions range from -1 to width/height (inclusive), i.e. the border cells have valid indices, too.
+    idx_t idx(int x, int y) const
+    {
+        assert(x >= -1 && x <= width_ && y >= -1 && y <= height_);
+        return (x + 1) + (y + 1) * stride;
+    }
+    idx_t idx(const Vec2<int>& pos) const {
+        return idx(pos.x, pos.y);
+    }
+
+    Vec2<int> pos(idx_t idx) const
+    {
+        assert(idx >= 0 && idx < std::ssize(data));
+        return Vec2<int>{.x = idx % stride - 1, .y = idx / stride - 1};
+    }
+
+    bool is_border(idx_t idx) const
+    {
+        const Vec2<int> p = pos(idx);
+        return p.x < 0 || p.x >= width_ || p.y < 0 || p.y >= height_;
+    }
+
+    // Signed index offsets to the 4 (or 8) neighbours of a cell; same order as all_dirs_vec2() (all_dirs_plus_diagonals_vec2()).
+    const std::array<idx_t, 4>& offsets4() const {
+        return offsets4_;
+    }
+    const std::array<idx_t, 8>& offsets8() const {
+        return offsets8_;
+    }
+    idx_t offset(const Vec2<int>& dir) const {
+        return dir.x + dir.y * stride;
+    }
+
+    ElemType& operator[](idx_t idx)
+    {
+        assert(idx >= 0 && idx < std::ssize(data));
+        return data[idx];
+    }
+    const ElemType& operator[](idx_t idx) const
+    {
+        assert(idx >= 0 && idx < std::ssize(data));
+        return data[idx];
+    }
+
+    // Number of cells including the border (i.e. all valid indices are in [0, size())).
+    idx_t size() const {
+        return std::ssize(data);
+    }
+    int width() const {
+        return width_;
+    }
+    int height() const {
+        return height_;
+    }
+
+    // Calls fn(idx, elem) for all inner (non-border) cells in row-major order.
+    template<typename Fn>
+    void foreach_idx(Fn fn) const
+    {
+        for (int y = 0; y < height_; ++y) {
+            for (idx_t i = idx(0, y), row_end = i + width_; i < row_end; ++i) {
+                fn(i, data[i]);
+            }
+        }
+    }
+
+    std::vector<idx_t> find_elem_indices(const ElemType& elem) const
+    {
+        std::vector<idx_t> indices;
+        foreach_idx([&indices, &elem](idx_t i, const ElemType& e) {
+            if (e == elem) {
+                indices.push_back(i);
+            }
+        });
+        return indices;
+    }
+
+    Grid<ElemType> to_grid() const
+    {
+        Grid<ElemType> grid(width_, height_, data.at(0));
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                grid[Vec2<int>{x, y}] = data[idx(x, y)];
+            }
+        }
+        return grid;
+    }
+};
+
+}
@@ -5,6 +5,13 @@
 #include <iostream>
 #include <concepts>
 #include <utility>
+#include <vector>
+#include <numeric>
+#include <functional>
+#include <mutex>
+#include <limits>
+#include <cassert>
+#include <string_view>
 
 namespace aocutil 
 { 
@@ -145,6 +152,20 @@ T parallel_transform_reduce(int num_threads, ForwardIt first, ForwardIt last, T
   return parallel_transform_reduce(first, last, init, reduce, transform, num_threads);
 }
 
+// Runs fn(row_begin, row_end) on num_threads bands of consecutive rows in parallel (num_threads 0: default number of threads) and returns the sum of the results.
+template<class RowBandFn>
+int64_t parallel_row_bands(int num_rows, int num_threads, RowBandFn fn)
+{
+    if (num_threads == 1 || num_rows <= 1) {
+        return fn(0, num_rows);
+    }
+    std::vector<int> rows(num_rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    return parallel_transform_reduce(rows.cbegin(), rows.cend(), int64_t{0}, std::plus<int64_t>(), [&fn](std::vector<int>::const_iterator first, std::vector<int>::const_iterator last) -> int64_t {
+        return fn(*first, *(last - 1) + 1);
+    }, num_threads);
+}
+
 // template<class ForwardIt, class WorkFn, class WorkFnResultOptional>
 // void parallel_search_first(ForwardIt begin, ForwardIt end, WorkFn work_fn, std::chrono::milliseconds busy_loop_sleep = 0)
 // {
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cassert>
+#include <optional>
+#include "grid.hpp"
+#include "vec.hpp"
+
+namespace aocutil
+{
+/*
+    Precomputed "distance to the next hit cell" for every cell and every direction (Up, Right, Down, Left) of a grid,
+    where a hit is any cell matching a predicate (e.g. obstacles). Built in four linear sweeps, so ray queries like
+    "where does the guard hit the next '#' going up" are O(1) instead of stepping cell by cell.
+    set_hit() updates a single cell and only recomputes its row and its column.
+*/
+class GridRayIndex
+{
+    int width_ = 0, height_ = 0;
+    std::vector<uint8_t> hits; // Grid<bool> would be a std::vector<bool>...
+    std::array<std::vector<int32_t>, 4> hit_dists; // Indexed by Direction; 0 means there is no hit cell in that direction.
+
+    int calc_idx(int x, int y) const {
+        return x + y * width_;
+    }
+
+    static int dir_idx(Direction dir)
+    {
+        if (dir == Direction::None) {
+            throw std::invalid_argument("GridRayIndex: Invalid direction");
+        }
+        return static_cast<int>(dir);
+    }
+
+    /*
+        Writes the distance to the previous hit cell (0: none so far) for the n cells first, first + stride, ... (reverse:
+        from the last one back to first) into dists. Unsigned indices: The signed x/y loops made GCC warn (-Wstrict-overflow).
+    */
+    template<bool reverse>
+    void sweep_line(std::vector<int32_t>& dists, std::size_t first, std::size_t stride, std::size_t n)
+    {
+        int32_t dist = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t idx = first + (reverse ? n - 1 - i : i) * stride;
+            dists[idx] = dist;
+            if (hits[idx]) {
+                dist = 1;
+            } else if (dist > 0) {
+                ++dist;
+            }
+        }
+    }
+
+    void sweep_row(int y)
+    {
+        const std::size_t first = static_cast<std::size_t>(calc_idx(0, y)), width = static_cast<std::size_t>(width_);
+        sweep_line<false>(hit_dists[dir_idx(Direction::Left)], first, 1, width);
+        sweep_line<true>(hit_dists[dir_idx(Direction::Right)], first, 1, width);
+    }
+
+    void sweep_col(int x)
+    {
+        const std::size_t first = static_cast<std::size_t>(x), width = static_cast<std::size_t>(width_);
+        sweep_line<false>(hit_dists[dir_idx(Direction::Up)], first, width, static_cast<std::size_t>(height_));
+        sweep_line<true>(hit_dists[dir_idx(Direction::Down)], first, width, static_cast<std::size_t>(height_));
+    }
+
+public:
+    GridRayIndex() = default;
+
+    template<typename ElemType, typename Predicate>
+    GridRayIndex(const Grid<ElemType>& grid, Predicate is_hit) : width_{grid.width()}, height_{grid.height()}
+    {
+        hits.resize(width_ * height_);
+        for (int idx = 0; idx < std::ssize(hits); ++idx) {
+            hits[idx] = is_hit(grid[idx]) ? 1 : 0;
+        }
+        for (auto& dists : hit_dists) {
+            dists.resize(hits.size());
+        }
+        for (int y = 0; y < height_; ++y) {
+            sweep_row(y);
+        }
+        for (int x = 0; x < width_; ++x) {
+            sweep_col(x);
+        }
+    }
+
+    bool pos_on_grid(const Vec2<int>& pos) const {
+        return pos.x >= 0 && pos.x < width_ && pos.y >= 0 && pos.y < height_;
+    }
+
+    bool is_hit(const Vec2<int>& pos) const
+    {
+        if (!pos_on_grid(pos)) {
+            throw std::out_of_range("GridRayIndex is_hit: invalid position");
+        }
+        return hits[calc_idx(pos.x, pos.y)];
+    }
+
+    // O(width + height): only the row and the column of pos are recomputed.
+    void set_hit(const Vec2<int>& pos, bool hit)
+    {
+        if (!pos_on_grid(pos)) {
+            throw std::out_of_range("GridRayIndex set_hit: invalid position");
+        }
+        uint8_t& h = hits[calc_idx(pos.x, pos.y)];
+        if (h == (hit ? 1 : 0)) {
+            return;
+        }
+        h = hit ? 1 : 0;
+        sweep_row(pos.y);
+        sweep_col(pos.x);
+    }
+
+    // Number of steps from pos to the next hit cell in direction dir (not counting pos itself), or {} if the ray leaves the grid.
+    std::optional<int> hit_distance(const Vec2<int>& pos, Direction dir) const
+    {
+        if (!pos_on_grid(pos)) {
+            throw std::out_of_range("GridRayIndex hit_distance: invalid position");
+        }
+        const int32_t dist = hit_dists[dir_idx(dir)][calc_idx(pos.x, pos.y)];
+        if (dist == 0) {
+            return {};
+        }
+        return dist;
+    }
+
+    // Position of the next hit cell from pos in direction dir, or {} if the ray leaves the grid.
+    std::optional<Vec2<int>> next_hit(const Vec2<int>& pos, Direction dir) const
+    {
+        const auto dist = hit_distance(pos, dir);
+        if (!dist.has_value()) {
+            return {};
+        }
+        return pos + dir_to_vec2<int>(dir) * dist.value();
+    }
+
+    // Number of steps one can move from pos in direction dir without either bumping into a hit cell or leaving the grid.
+    int free_steps(const Vec2<int>& pos, Direction dir) const
+    {
+        if (const auto dist = hit_distance(pos, dir); dist.has_value()) {
+            return dist.value() - 1;
+        }
+        switch (dir) {
+            case Direction::Up:
+                return pos.y;
+            case Direction::Right:
+                return width_ - 1 - pos.x;
+            case Direction::Down:
+                return height_ - 1 - pos.y;
+            case Direction::Left:
+                return pos.x;
+            default:
+                throw std::invalid_argument("GridRayIndex free_steps: Invalid direction");
+        }
+    }
+
+    int width() const {
+        return width_;
+    }
+    int height() const {
+        return height_;
+    }
+};
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <bit>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <shared_mutex>
+#include "lru-cache.hpp"
+#include "parallel.hpp"
+
+/*
+    Thread-safe LRU cache for memoisation inside parallel workers (e.g. the parallel_transform_reduce workers of day 7):
+    The keys are split by hash across num_shards independent LRUCaches (each with its own intrusive list and capacity
+    capacity / num_shards), and every shard has its own lock, so threads only wait for each other if they access the same
+    shard at the same time. The eviction order is least recently used per shard (not globally), or that of another
+    EvictionPolicy (cf. eviction-policy.hpp), also applied per shard.
+    - get_copy/insert/get_or_compute lock their shard exclusively (a hit moves the node to the head of the list).
+    - peek is the relaxed read path: It does not mark the element as used (if an element is only ever peeked at, it ages
+      like an unused one), so it only reads the shard. With Mutex = std::shared_mutex, it only takes a shared lock, and
+      concurrent peeks of the same shard don't block each other. std::mutex is the default nonetheless: Exclusive locking
+      of a std::shared_mutex is slower, and much slower if there are more threads than cores.
+      A truly lock-free hit path would need a different (e.g. CLOCK-like) cache, since an LRU hit writes to the list.
+    - get_or_compute calls fn without holding any lock (fn may use the cache itself, or take long); if two threads miss
+      the same key at the same time, both compute it and the first inserted value is kept.
+    Every shard counts its hits, misses and contended lock acquisitions (the lock was held by another thread), cf. stats().
+    cf. https://github.com/facebook/CacheLib (last retrieved 2024-12-20) for sharded caches in general.
+*/
+
+namespace aocutil
+{
+struct ShardStats
+{
+    uint64_t hits = 0, misses = 0, contended = 0;
+
+    ShardStats& operator+=(const ShardStats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        contended += other.contended;
+        return *this;
+    }
+};
+
+template<typename Key, typename Val, typename Hash = FastHash<Key>, typename Mutex = std::mutex, EvictionPolicy policy = EvictionPolicy::LRU>
+class ShardedLRUCache
+{
+private:
+    static constexpr bool shared_reads = requires (Mutex& m) { m.lock_shared(); };
+
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr int SHARDS_PER_THREAD_DEFAULT = 4;
+    static constexpr int SHARD_HASH_SHIFT = 8; // Bits below are used as fingerprints by the shards' FlatMaps, and the top bits pick their buckets.
+
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        mutable Mutex mutex;
+        LRUCache<Key, Val, 0, Hash, policy> cache;
+        mutable std::atomic<uint64_t> hits{0}, misses{0}, contended{0};
+
+        explicit Shard(std::size_t capacity) : cache(capacity) {}
+
+        std::unique_lock<Mutex> lock() const
+        {
+            std::unique_lock guard{mutex, std::try_to_lock};
+            if (!guard.owns_lock()) {
+                contended.fetch_add(1, std::memory_order_relaxed);
+                guard.lock();
+            }
+            return guard;
+        }
+        auto lock_shared() const
+        {
+            if constexpr (shared_reads) {
+                std::shared_lock guard{mutex, std::try_to_lock};
+                if (!guard.owns_lock()) {
+                    contended.fetch_add(1, std::memory_order_relaxed);
+                    guard.lock();
+                }
+                return guard;
+            } else {
+                return lock();
+            }
+        }
+        void count(bool hit) const
+        {
+            std::atomic<uint64_t>& counter = hit ? hits : misses;
+            if constexpr (shared_reads) { // Concurrent peeks of the same shard.
+                counter.fetch_add(1, std::memory_order_relaxed);
+            } else { // Only the lock holder writes.
+                counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    [[no_unique_address]] Hash hasher;
+    std::size_t num_shards_;
+    std::vector<std::unique_ptr<Shard>> shards; // Shards hold a mutex, so they are neither copyable nor movable.
+    std::size_t capacity_;
+
+    Shard& shard_of(const Key& key) const {
+        return *shards[(static_cast<uint64_t>(hasher(key)) >> SHARD_HASH_SHIFT) & (num_shards_ - 1)];
+    }
+
+    static std::size_t num_shards_default() {
+        return std::bit_ceil(static_cast<std::size_t>(get_num_threads_default() * SHARDS_PER_THREAD_DEFAULT));
+    }
+
+public:
+    // The capacity is split evenly between the shards (num_shards 0: four per default number of threads; rounded up to a power of two).
+    explicit ShardedLRUCache(std::size_t capacity, std::size_t num_shards = 0)
+        : num_shards_{std::bit_ceil(num_shards == 0 ? num_shards_default() : num_shards)}
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("ShardedLRUCache::ShardedLRUCache: Invalid capacity");
+        }
+        num_shards_ = std::min(num_shards_, std::bit_floor(capacity)); // Every shard needs room for at least one element.
+        const std::size_t shard_capacity = (capacity + num_shards_ - 1) / num_shards_;
+        capacity_ = shard_capacity * num_shards_;
+        shards.reserve(num_shards_);
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            shards.push_back(std::make_unique<Shard>(shard_capacity));
+        }
+    }
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    std::size_t num_shards() const {
+        return num_shards_;
+    }
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+    // Number of cached elements (only a snapshot if other threads modify the cache concurrently).
+    std::size_t size() const
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            const auto guard = shards[i]->lock_shared();
+            total += shards[i]->cache.size();
+        }
+        return total;
+    }
+
+    void clear()
+    {
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            const auto guard = shards[i]->lock();
+            shards[i]->cache.clear();
+        }
+    }
+
+    bool contains(const Key& key) const
+    {
+        const Shard& shard = shard_of(key);
+        const auto guard = shard.lock_shared();
+        return shard.cache.contains(key);
+    }
+
+    // Relaxed read: Only takes a shared lock and does not mark the element as used.
+    std::optional<Val> peek(const Key& key) const
+    {
+        const Shard& shard = shard_of(key);
+        const auto guard = shard.lock_shared();
+        const Val* val = shard.cache.peek(key);
+        shard.count(val != nullptr);
+        return val ? std::optional<Val>(*val) : std::nullopt;
+    }
+
+    std::optional<Val> get_copy(const Key& key)
+    {
+        Shard& shard = shard_of(key);
+        const auto guard = shard.lock();
+        const Val* val = shard.cache.find(key);
+        shard.count(val != nullptr);
+        return val ? std::optional<Val>(*val) : std::nullopt;
+    }
+
+    template<typename V = Val>
+    void insert(const Key& key, V&& val)
+    {
+        Shard& shard = shard_of(key);
+        const auto guard = shard.lock();
+        shard.cache.insert(key, std::forward<V>(val));
+    }
+
+    // Returns true if the value was inserted, false if key was already cached (cf. LRUCache::try_emplace).
+    template<typename... Args>
+    bool try_emplace(const Key& key, Args&&... args)
+    {
+        Shard& shard = shard_of(key);
+        const auto guard = shard.lock();
+        return shard.cache.try_emplace(key, std::forward<Args>(args)...).second;
+    }
+
+    // Returns (a copy of) the value of key, which is computed with fn() if key is not cached (fn is called without holding a lock).
+    template<typename Fn>
+    Val get_or_compute(const Key& key, Fn&& fn)
+    {
+        if (std::optional<Val> val = get_copy(key)) {
+            return std::move(*val);
+        }
+        Val val = std::forward<Fn>(fn)();
+        Shard& shard = shard_of(key);
+        const auto guard = shard.lock();
+        if (const Val* cached = shard.cache.peek(key)) { // Inserted by another thread in the meantime (peek, so the miss isn't counted twice).
+            return *cached;
+        }
+        shard.cache.insert(key, val);
+        return val;
+    }
+
+    ShardStats shard_stats(std::size_t shard_idx) const
+    {
+        if (shard_idx >= num_shards_) {
+            throw std::out_of_range("ShardedLRUCache shard_stats: Invalid shard index");
+        }
+        const Shard& shard = *shards[shard_idx];
+        return ShardStats{.hits = shard.hits.load(std::memory_order_relaxed), .misses = shard.misses.load(std::memory_order_relaxed),
+                          .contended = shard.contended.load(std::memory_order_relaxed)};
+    }
+
+    // Sum of the statistics of all shards.
+    ShardStats stats() const
+    {
+        ShardStats total;
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            total += shard_stats(i);
+        }
+        return total;
+    }
+
+    // Sum of the LRUStats of the shards' caches (all zero without AOC_LRU_STATS).
+    LRUStats lru_stats() const
+    {
+        LRUStats total;
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            const auto guard = shards[i]->lock_shared();
+            total += shards[i]->cache.stats();
+        }
+        return total;
+    }
+
+    void reset_stats()
+    {
+        for (std::size_t i = 0; i < num_shards_; ++i) {
+            shards[i]->hits.store(0, std::memory_order_relaxed);
+            shards[i]->misses.store(0, std::memory_order_relaxed);
+            shards[i]->contended.store(0, std::memory_order_relaxed);
+            const auto guard = shards[i]->lock();
+            shards[i]->cache.reset_stats();
+        }
+    }
+};
+
+}
@@ -0,0 +1,539 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "vec.hpp"
+#include "parallel.hpp"
+
+/*
+    Spatial indices over a fixed set of Vec2 points, for "who is near whom" queries without comparing all pairs:
+    - BucketGrid: Uniform grid of square cells (about SPATIAL_BUCKET_TARGET_LOAD points per cell); the points are sorted
+      by cell, so every cell is a contiguous range. Best for roughly uniformly spread points (e.g. robots on a grid).
+    - KDTree: Implicit, balanced 2-d tree (every subrange is split at its median along its wider axis). Adapts to
+      clustered points. cf. https://en.wikipedia.org/wiki/K-d_tree (last retrieved 2024-12-20)
+    Both are built in O(n log n) (the bucket grid even in O(n + cells)) and have the same interface:
+        query_box(min, max, out)            Indices of all points p with min <= p <= max (component-wise).
+        query_radius(centre, r, out, metric) Indices of all points within distance r of centre.
+        count_radius(centre, r, metric)      Number of points within distance r of centre.
+        nearest(p, metric, exclude)          Index of the point closest to p (ties: any), except the point exclude.
+    Indices refer to the order of the points given to the constructor. The batch queries and cluster statistics below
+    work with either backend.
+*/
+
+namespace aocutil
+{
+enum class Metric {Euclidean, Manhattan, Chebyshev};
+
+constexpr int SPATIAL_BUCKET_TARGET_LOAD = 2;
+
+namespace spatial_impl
+{
+// Distances between integer points are int64_t (no overflow for int coordinates), Euclidean distances are squared.
+template<typename T>
+using Dist = std::conditional_t<std::is_integral_v<T>, int64_t, T>;
+
+template<typename T>
+Dist<T> axis_dist(T a, T b) {
+    return a < b ? Dist<T>(b) - Dist<T>(a) : Dist<T>(a) - Dist<T>(b);
+}
+
+template<typename T>
+Dist<T> dist(Metric metric, const Vec2<T>& a, const Vec2<T>& b)
+{
+    const Dist<T> dx = axis_dist(a.x, b.x), dy = axis_dist(a.y, b.y);
+    switch (metric) {
+        case Metric::Euclidean:
+            return dx * dx + dy * dy;
+        case Metric::Manhattan:
+            return dx + dy;
+        case Metric::Chebyshev:
+            return std::max(dx, dy);
+        default:
+            throw std::invalid_argument("spatial dist: Invalid metric");
+    }
+}
+
+// Radius (or a gap along one axis, which is a lower bound of the distance in all metrics) in the units of dist.
+template<typename T>
+Dist<T> dist_of_gap(Metric metric, Dist<T> gap) {
+    return metric == Metric::Euclidean ? gap * gap : gap;
+}
+
+/*
+    Rearranges [first, last) like std::nth_element (by key(elem)) with quickselect: A three-way partition (less, equal,
+    greater than the median of three) per round, so runs of equal keys end the search instead of degrading it.
+    (Not std::nth_element: Its heap fallback makes GCC 12 warn with -Wstrict-overflow wherever it is inlined.)
+*/
+template<typename It, typename Key>
+void select_nth(It first, It nth, It last, Key key)
+{
+    while (last - first > 1) {
+        const auto a = key(*first), b = key(*(first + (last - first) / 2)), c = key(*(last - 1));
+        const auto pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+        const It equal_begin = std::partition(first, last, [&](const auto& elem) { return key(elem) < pivot; });
+        const It equal_end = std::partition(equal_begin, last, [&](const auto& elem) { return !(pivot < key(elem)); });
+        if (nth < equal_begin) {
+            last = equal_begin;
+        } else if (nth >= equal_end) {
+            first = equal_end;
+        } else {
+            return;
+        }
+    }
+}
+
+template<typename T>
+void require_radius(T radius, const char* what)
+{
+    if (radius < 0) {
+        throw std::invalid_argument(std::string(what) + ": radius < 0");
+    }
+}
+}
+
+template<typename T = int>
+class BucketGrid
+{
+    using Dist = spatial_impl::Dist<T>;
+
+    std::vector<Vec2<T>> points_;
+    std::vector<Vec2<T>> sorted;    // points_ sorted by cell (copied, so the cell loops read contiguous memory).
+    std::vector<int> sorted_idx;    // sorted[i] == points_[sorted_idx[i]]
+    std::vector<int> cell_start;    // Cell c holds sorted[cell_start[c], cell_start[c + 1]).
+    Vec2<T> origin {0, 0};
+    T cell_size_ {1};
+    int64_t cols = 0, rows = 0;
+
+    // Cell coordinates of p (not clamped to the grid).
+    int64_t cell_coord(T p, T o) const
+    {
+        if constexpr (std::is_integral_v<T>) {
+            const int64_t d = int64_t(p) - int64_t(o);
+            return d >= 0 ? d / cell_size_ : -((-d + cell_size_ - 1) / cell_size_);
+        } else {
+            return static_cast<int64_t>(std::floor((p - o) / cell_size_));
+        }
+    }
+    int64_t clamp_col(int64_t c) const {
+        return std::clamp<int64_t>(c, 0, cols - 1);
+    }
+    int64_t clamp_row(int64_t r) const {
+        return std::clamp<int64_t>(r, 0, rows - 1);
+    }
+
+    // Calls fn(idx_in_sorted) for all points in the cells [c0, c1] x [r0, r1] (clamped to the grid).
+    template<typename Fn>
+    void foreach_in_cells(int64_t c0, int64_t r0, int64_t c1, int64_t r1, Fn fn) const
+    {
+        if (points_.empty() || c1 < 0 || r1 < 0 || c0 >= cols || r0 >= rows) {
+            return;
+        }
+        c0 = clamp_col(c0), c1 = clamp_col(c1), r0 = clamp_row(r0), r1 = clamp_row(r1);
+        for (int64_t r = r0; r <= r1; ++r) {
+            // The cells of a row are contiguous in sorted, so a row of cells is a single range.
+            const int begin = cell_start[r * cols + c0], end = cell_start[r * cols + c1 + 1];
+            for (int i = begin; i < end; ++i) {
+                fn(i);
+            }
+        }
+    }
+
+public:
+    BucketGrid() = default;
+    // cell_size <= 0: Chosen so there are about SPATIAL_BUCKET_TARGET_LOAD points per cell if the points are spread evenly.
+    explicit BucketGrid(std::span<const Vec2<T>> points, T cell_size = T{0}) : points_(points.begin(), points.end())
+    {
+        if (points_.empty()) {
+            return;
+        }
+        Vec2<T> lo = points_.front(), hi = points_.front();
+        for (const Vec2<T>& p : points_) {
+            lo = {std::min(lo.x, p.x), std::min(lo.y, p.y)};
+            hi = {std::max(hi.x, p.x), std::max(hi.y, p.y)};
+        }
+        origin = lo;
+        const double width = double(hi.x) - double(lo.x), height = double(hi.y) - double(lo.y);
+        const double max_cells = std::max(1.0, double(points_.size()) / SPATIAL_BUCKET_TARGET_LOAD);
+        if (cell_size <= T{0}) {
+            double size = std::sqrt(std::max(width, 1.0) * std::max(height, 1.0) / max_cells);
+            cell_size = std::is_integral_v<T> ? static_cast<T>(std::max(1.0, std::ceil(size))) : static_cast<T>(std::max(size, 1e-9));
+        }
+        cell_size_ = cell_size;
+        // Degenerate extents (e.g. all points on one line) or a tiny given cell size must not make the grid huge.
+        while (true) {
+            cols = cell_coord(hi.x, lo.x) + 1;
+            rows = cell_coord(hi.y, lo.y) + 1;
+            if (double(cols) * double(rows) <= 4 * max_cells + 16) {
+                break;
+            }
+            cell_size_ *= 2;
+        }
+
+        // Counting sort by cell.
+        cell_start = std::vector<int>(cols * rows + 1, 0);
+        std::vector<int64_t> cell_of(points_.size());
+        for (std::size_t i = 0; i < points_.size(); ++i) {
+            cell_of[i] = cell_coord(points_[i].y, origin.y) * cols + cell_coord(points_[i].x, origin.x);
+            ++cell_start[cell_of[i] + 1];
+        }
+        std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+        std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+        sorted = std::vector<Vec2<T>>(points_.size());
+        sorted_idx = std::vector<int>(points_.size());
+        for (std::size_t i = 0; i < points_.size(); ++i) {
+            const int dst = fill[cell_of[i]]++;
+            sorted[dst] = points_[i];
+            sorted_idx[dst] = static_cast<int>(i);
+        }
+    }
+
+    const std::vector<Vec2<T>>& points() const {
+        return points_;
+    }
+    std::size_t size() const {
+        return points_.size();
+    }
+    T cell_size() const {
+        return cell_size_;
+    }
+
+    void query_box(const Vec2<T>& min, const Vec2<T>& max, std::vector<int>& out) const
+    {
+        foreach_in_cells(cell_coord(min.x, origin.x), cell_coord(min.y, origin.y), cell_coord(max.x, origin.x), cell_coord(max.y, origin.y), [&](int i) {
+            const Vec2<T>& p = sorted[i];
+            if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y) {
+                out.push_back(sorted_idx[i]);
+            }
+        });
+    }
+
+    template<typename Fn>
+    void foreach_in_radius(const Vec2<T>& centre, T radius, Metric metric, Fn fn) const
+    {
+        spatial_impl::require_radius(radius, "BucketGrid foreach_in_radius");
+        const Dist max_dist = spatial_impl::dist_of_gap<T>(metric, Dist(radius));
+        const Vec2<T> min = {centre.x - radius, centre.y - radius}, max = {centre.x + radius, centre.y + radius};
+        foreach_in_cells(cell_coord(min.x, origin.x), cell_coord(min.y, origin.y), cell_coord(max.x, origin.x), cell_coord(max.y, origin.y), [&](int i) {
+            if (spatial_impl::dist(metric, sorted[i], centre) <= max_dist) {
+                fn(sorted_idx[i]);
+            }
+        });
+    }
+
+    void query_radius(const Vec2<T>& centre, T radius, std::vector<int>& out, Metric metric = Metric::Euclidean) const {
+        foreach_in_radius(centre, radius, metric, [&out](int idx) { out.push_back(idx); });
+    }
+
+    int count_radius(const Vec2<T>& centre, T radius, Metric metric = Metric::Euclidean) const
+    {
+        int count = 0;
+        foreach_in_radius(centre, radius, metric, [&count](int) { ++count; });
+        return count;
+    }
+
+    /*
+        Searches the rings of cells around the cell of p (ring k: the cells at Chebyshev distance k) until the next ring
+        cannot contain anything closer than the best point found so far.
+    */
+    std::optional<int> nearest(const Vec2<T>& p, Metric metric = Metric::Euclidean, int exclude = -1) const
+    {
+        if (points_.empty()) {
+            return {};
+        }
+        const int64_t pc = cell_coord(p.x, origin.x), pr = cell_coord(p.y, origin.y);
+        const int64_t max_ring = std::max({pc, cols - 1 - pc, pr, rows - 1 - pr}); // Beyond it, all rings are outside of the grid.
+        int best = -1;
+        Dist best_dist = std::numeric_limits<Dist>::max();
+        const auto consider = [&](int i) {
+            const Dist d = spatial_impl::dist(metric, sorted[i], p);
+            if (d < best_dist && sorted_idx[i] != exclude) {
+                best_dist = d, best = sorted_idx[i];
+            }
+        };
+        for (int64_t k = 0; k <= max_ring; ++k) {
+            if (best != -1) {
+                // Distance from p to the outside of rings 0..k-1 (which contain p) bounds the distance to all points in ring k and beyond.
+                const T x0 = origin.x + static_cast<T>((pc - k + 1) * cell_size_), x1 = origin.x + static_cast<T>((pc + k) * cell_size_);
+                const T y0 = origin.y + static_cast<T>((pr - k + 1) * cell_size_), y1 = origin.y + static_cast<T>((pr + k) * cell_size_);
+                Dist gap = std::min({spatial_impl::axis_dist(p.x, x0), spatial_impl::axis_dist(p.x, x1), spatial_impl::axis_dist(p.y, y0), spatial_impl::axis_dist(p.y, y1)});
+                if constexpr (std::is_integral_v<T>) {
+                    gap = gap > 0 ? gap - 1 : 0; // Coordinates in the ring are at least x1, but p might be at x1 - 1 already.
+                }
+                if (spatial_impl::dist_of_gap<T>(metric, gap) >= best_dist) {
+                    break;
+                }
+            }
+            if (k == 0) {
+                foreach_in_cells(pc, pr, pc, pr, consider);
+                continue;
+            }
+            const int64_t c0 = pc - k, c1 = pc + k, r0 = pr - k, r1 = pr + k;
+            foreach_in_cells(c0, r0, c1, r0, consider); // Top and bottom row of the ring.
+            foreach_in_cells(c0, r1, c1, r1, consider);
+            const int64_t r_end = std::min(r1, rows);
+            for (int64_t r = r0 < 0 ? 0 : r0 + 1; r < r_end; ++r) { // Left and right column.
+                foreach_in_cells(c0, r, c0, r, consider);
+                foreach_in_cells(c1, r, c1, r, consider);
+            }
+        }
+        return best == -1 ? std::nullopt : std::optional<int>(best);
+    }
+};
+
+template<typename T>
+BucketGrid(const std::vector<Vec2<T>>&) -> BucketGrid<T>;
+template<typename T>
+BucketGrid(const std::vector<Vec2<T>>&, T) -> BucketGrid<T>;
+
+template<typename T = int>
+class KDTree
+{
+    using Dist = spatial_impl::Dist<T>;
+
+    struct Node
+    {
+        Vec2<T> pos;
+        int idx;      // Index into points_.
+        bool split_x; // Whether the subrange with this node as its median is split along x (otherwise along y).
+        Vec2<T> box_min, box_max; // Bounding box of that subrange.
+    };
+
+    std::vector<Vec2<T>> points_;
+    std::vector<Node> nodes; // The median of every subrange [lo, hi) is at (lo + hi) / 2.
+
+    static T coord(const Vec2<T>& p, bool x) {
+        return x ? p.x : p.y;
+    }
+
+    void build(int lo, int hi)
+    {
+        if (hi - lo <= 0) {
+            return;
+        }
+        Vec2<T> min = nodes[lo].pos, max = nodes[lo].pos;
+        for (int i = lo; i < hi; ++i) {
+            min = {std::min(min.x, nodes[i].pos.x), std::min(min.y, nodes[i].pos.y)};
+            max = {std::max(max.x, nodes[i].pos.x), std::max(max.y, nodes[i].pos.y)};
+        }
+        const bool along_x = Dist(max.x) - Dist(min.x) >= Dist(max.y) - Dist(min.y);
+        const int mid = lo + (hi - lo) / 2;
+        spatial_impl::select_nth(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi, [along_x](const Node& node) {
+            return coord(node.pos, along_x);
+        });
+        nodes[mid].split_x = along_x;
+        nodes[mid].box_min = min;
+        nodes[mid].box_max = max;
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    // Left subtree: coordinates <= median, right subtree: coordinates >= median (along the split axis).
+    template<typename Fn>
+    void foreach_in_box(int lo, int hi, const Vec2<T>& min, const Vec2<T>& max, Fn& fn) const
+    {
+        while (hi - lo > 0) {
+            const int mid = lo + (hi - lo) / 2;
+            const Node& node = nodes[mid];
+            if (node.pos.x >= min.x && node.pos.x <= max.x && node.pos.y >= min.y && node.pos.y <= max.y) {
+                fn(node);
+            }
+            const bool go_left = coord(min, node.split_x) <= coord(node.pos, node.split_x), go_right = coord(max, node.split_x) >= coord(node.pos, node.split_x);
+            if (go_left && go_right) {
+                foreach_in_box(lo, mid, min, max, fn);
+                lo = mid + 1;
+            } else if (go_left) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+    }
+
+    void nearest_rec(int lo, int hi, const Vec2<T>& p, Metric metric, int exclude, int& best, Dist& best_dist) const
+    {
+        if (hi - lo <= 0) {
+            return;
+        }
+        const int mid = lo + (hi - lo) / 2;
+        const Node& node = nodes[mid];
+        // Skip the whole subrange if its bounding box is not closer than the best point so far (clusters far away from p
+        // would otherwise be searched completely, since the splitting lines within them are all about equally far away).
+        const Vec2<T> closest = {std::clamp(p.x, node.box_min.x, node.box_max.x), std::clamp(p.y, node.box_min.y, node.box_max.y)};
+        if (spatial_impl::dist(metric, closest, p) >= best_dist) {
+            return;
+        }
+        const Dist d = spatial_impl::dist(metric, node.pos, p);
+        if (d < best_dist && node.idx != exclude) {
+            best_dist = d, best = node.idx;
+        }
+        const T pc = coord(p, node.split_x), mc = coord(node.pos, node.split_x);
+        const bool left_first = pc <= mc;
+        nearest_rec(left_first ? lo : mid + 1, left_first ? mid : hi, p, metric, exclude, best, best_dist);
+        if (spatial_impl::dist_of_gap<T>(metric, spatial_impl::axis_dist(pc, mc)) < best_dist) { // The far side can only be closer if the splitting line is.
+            nearest_rec(left_first ? mid + 1 : lo, left_first ? hi : mid, p, metric, exclude, best, best_dist);
+        }
+    }
+
+public:
+    KDTree() = default;
+    explicit KDTree(std::span<const Vec2<T>> points) : points_(points.begin(), points.end())
+    {
+        nodes.reserve(points_.size());
+        for (int i = 0; i < std::ssize(points_); ++i) {
+            nodes.push_back(Node{.pos = points_[i], .idx = i, .split_x = true, .box_min = points_[i], .box_max = points_[i]});
+        }
+        build(0, std::ssize(nodes));
+    }
+
+    const std::vector<Vec2<T>>& points() const {
+        return points_;
+    }
+    std::size_t size() const {
+        return points_.size();
+    }
+
+    void query_box(const Vec2<T>& min, const Vec2<T>& max, std::vector<int>& out) const
+    {
+        auto fn = [&out](const Node& node) { out.push_back(node.idx); };
+        foreach_in_box(0, std::ssize(nodes), min, max, fn);
+    }
+
+    template<typename Fn>
+    void foreach_in_radius(const Vec2<T>& centre, T radius, Metric metric, Fn fn) const
+    {
+        spatial_impl::require_radius(radius, "KDTree foreach_in_radius");
+        const Dist max_dist = spatial_impl::dist_of_gap<T>(metric, Dist(radius));
+        auto filter = [&](const Node& node) {
+            if (spatial_impl::dist(metric, node.pos, centre) <= max_dist) {
+                fn(node.idx);
+            }
+        };
+        foreach_in_box(0, std::ssize(nodes), Vec2<T>{centre.x - radius, centre.y - radius}, Vec2<T>{centre.x + radius, centre.y + radius}, filter);
+    }
+
+    void query_radius(const Vec2<T>& centre, T radius, std::vector<int>& out, Metric metric = Metric::Euclidean) const {
+        foreach_in_radius(centre, radius, metric, [&out](int idx) { out.push_back(idx); });
+    }
+
+    int count_radius(const Vec2<T>& centre, T radius, Metric metric = Metric::Euclidean) const
+    {
+        int count = 0;
+        foreach_in_radius(centre, radius, metric, [&count](int) { ++count; });
+        return count;
+    }
+
+    std::optional<int> nearest(const Vec2<T>& p, Metric metric = Metric::Euclidean, int exclude = -1) const
+    {
+        int best = -1;
+        Dist best_dist = std::numeric_limits<Dist>::max();
+        nearest_rec(0, std::ssize(nodes), p, metric, exclude, best, best_dist);
+        return best == -1 ? std::nullopt : std::optional<int>(best);
+    }
+};
+
+template<typename T>
+KDTree(const std::vector<Vec2<T>>&) -> KDTree<T>;
+
+/*
+    Batch queries: One result per query point, the queries are split between num_threads threads.
+*/
+template<typename Index, typename T>
+std::vector<std::optional<int>> nearest_batch(const Index& index, std::span<const Vec2<T>> queries, Metric metric = Metric::Euclidean, int num_threads = 1)
+{
+    std::vector<std::optional<int>> result(queries.size());
+    parallel_row_bands(std::ssize(queries), num_threads, [&](int begin, int end) -> int64_t {
+        for (int i = begin; i < end; ++i) {
+            result[i] = index.nearest(queries[i], metric);
+        }
+        return 0;
+    });
+    return result;
+}
+
+template<typename Index, typename T>
+std::vector<int> count_radius_batch(const Index& index, std::span<const Vec2<T>> queries, T radius, Metric metric = Metric::Euclidean, int num_threads = 1)
+{
+    std::vector<int> result(queries.size());
+    parallel_row_bands(std::ssize(queries), num_threads, [&](int begin, int end) -> int64_t {
+        for (int i = begin; i < end; ++i) {
+            result[i] = index.count_radius(queries[i], radius, metric);
+        }
+        return 0;
+    });
+    return result;
+}
+
+/*
+    Cluster and density statistics of the indexed points themselves:
+    - neighbour_counts: Number of other points within radius of every point (local density).
+    - find_clusters: Connected components of the graph in which points within radius of each other are adjacent
+      (single-linkage clustering), via union-find over the radius queries.
+*/
+template<typename Index, typename T>
+std::vector<int> neighbour_counts(const Index& index, T radius, Metric metric = Metric::Euclidean, int num_threads = 1)
+{
+    std::vector<int> counts = count_radius_batch(index, std::span<const Vec2<T>>(index.points()), radius, metric, num_threads);
+    for (int& count : counts) {
+        --count; // The point itself.
+    }
+    return counts;
+}
+
+struct Clusters
+{
+    std::vector<int> labels; // Cluster of every point, in [0, sizes.size()).
+    std::vector<int> sizes;  // Number of points of every cluster.
+
+    int num_clusters() const {
+        return std::ssize(sizes);
+    }
+    int largest() const {
+        return sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+    }
+};
+
+template<typename Index, typename T>
+Clusters find_clusters(const Index& index, T radius, Metric metric = Metric::Euclidean)
+{
+    const int n = std::ssize(index.points());
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    const auto find = [&parent](int i) {
+        while (parent[i] != i) {
+            i = parent[i] = parent[parent[i]]; // Path halving.
+        }
+        return i;
+    };
+    for (int i = 0; i < n; ++i) {
+        index.foreach_in_radius(index.points()[i], radius, metric, [&](int j) {
+            const int a = find(i), b = find(j);
+            if (a != b) {
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        });
+    }
+    Clusters clusters {.labels = std::vector<int>(n, -1), .sizes = {}};
+    std::vector<int> label_of_root(n, -1);
+    for (int i = 0; i < n; ++i) {
+        const int root = find(i);
+        if (label_of_root[root] == -1) {
+            label_of_root[root] = clusters.num_clusters();
+            clusters.sizes.push_back(0);
+        }
+        clusters.labels[i] = label_of_root[root];
+        ++clusters.sizes[clusters.labels[i]];
+    }
+    return clusters;
+}
+
+}
@@ -154,16 +154,23 @@ constexpr std::pair<Direction, Direction> dir_get_left_right(Direction dir)
 }
 
 template<typename T>
-struct std::hash<aocutil::Vec2<T>>
+struct aocutil::FastHash<aocutil::Vec2<T>>
 {
+    // Coordinates of up to 32 bits are packed into one 64-bit value, which is hashed with a single multiplication.
     std::size_t operator()(const aocutil::Vec2<T>& v) const noexcept
     {
-        std::size_t h = 0;
-        aocutil::hash_combine(h, v.x, v.y);
-        return h; 
+        if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(uint32_t)) {
+            const uint64_t packed = static_cast<uint32_t>(v.x) | (static_cast<uint64_t>(static_cast<uint32_t>(v.y)) << 32);
+            return aocutil::hash_u64(packed);
+        } else {
+            return aocutil::hash_mix(aocutil::FastHash<T>{}(v.x), aocutil::FastHash<T>{}(v.y));
+        }
     }
 };
 
+template<typename T>
+struct std::hash<aocutil::Vec2<T>> : aocutil::FastHash<aocutil::Vec2<T>> {};
+
 template<typename T>
 inline std::ostream& operator<<(std::ostream&os, const aocutil::Vec2<T>& v) {
     return os << "(x: " << v.x << ", y: " << v.y << ")";
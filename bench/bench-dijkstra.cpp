@@ -0,0 +1,325 @@
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wstrict-overflow" // GCC 12 warns inside libstdc++'s heap functions (std::priority_queue).
+#endif
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <functional>
+#include "aoclib/prio-queue.hpp"
+#include "aoclib/bucket-queue.hpp"
+
+/*
+    Benchmark: Priority queues in Dijkstra (single source, all nodes) on synthetic graphs:
+        - grid: n x n grid, 4-neighbourhood, the weight of an edge is the weight of the cell it enters.
+        - random: n * n nodes with 4 random out-edges each (plus a path through all nodes, so all are reachable).
+      Edge weights: [1, 9] (the usual AoC grids), {1, 1000} (90% 1, like day 16's moves and turns) or [1, 100000].
+    Queues:
+        - multimap: The previous PrioQueue (std::multimap of priorities plus a FlatMap of multimap iterators), decrease-key.
+        - d=2/4/8: PrioQueue (indexed d-ary heap with a FlatMap from elements to handles) of arity 2, 4 (the default), 8.
+        - lazy: std::priority_queue without decrease-key; stale entries are skipped when extracted.
+        - radix/dial: RadixHeap and DialQueue (bucket-queue.hpp) on the dense node ids, decrease-key.
+    Per queue: ns per queue operation (insert/update/extract), the largest number of entries in the queue (for lazy:
+    including stale ones), and the peak heap memory allocated during the run (counted by the operator new below).
+    Run with: cmake --build build/Release --target run-bench-dijkstra (optional argument: n, default 1024)
+*/
+
+namespace
+{
+std::size_t allocated_bytes = 0, peak_allocated_bytes = 0;
+
+// Every allocation is prefixed by its size (in a block of the allocation's alignment, so the result stays aligned).
+void* counted_alloc(std::size_t size, std::size_t align)
+{
+    align = std::max(align, alignof(std::max_align_t));
+    void* block = std::aligned_alloc(align, (align + size + align - 1) / align * align);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<std::size_t*>(block) = size;
+    allocated_bytes += size;
+    peak_allocated_bytes = std::max(peak_allocated_bytes, allocated_bytes);
+    return static_cast<char*>(block) + align;
+}
+
+void counted_free(void* ptr, std::size_t align)
+{
+    if (!ptr) {
+        return;
+    }
+    align = std::max(align, alignof(std::max_align_t));
+    void* block = static_cast<char*>(ptr) - align;
+    allocated_bytes -= *static_cast<std::size_t*>(block);
+    std::free(block);
+}
+}
+
+void* operator new(std::size_t size) {
+    return counted_alloc(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    return counted_alloc(size, static_cast<std::size_t>(align));
+}
+void operator delete(void* ptr) noexcept {
+    counted_free(ptr, alignof(std::max_align_t));
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    counted_free(ptr, alignof(std::max_align_t));
+}
+void operator delete(void* ptr, std::align_val_t align) noexcept {
+    counted_free(ptr, static_cast<std::size_t>(align));
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t align) noexcept {
+    counted_free(ptr, static_cast<std::size_t>(align));
+}
+
+using clk = std::chrono::steady_clock;
+
+template<typename T, typename PrioType = int>
+class MultimapPrioQueue
+{
+    std::multimap<PrioType, T> prio_to_elem;
+    aocutil::FlatMap<T, typename decltype(prio_to_elem)::iterator> elem_to_prio;
+
+public:
+    void insert_or_update(const T& elem, const PrioType& prio)
+    {
+        const auto [it, inserted] = elem_to_prio.try_emplace(elem);
+        if (!inserted) {
+            prio_to_elem.erase(it->second);
+        }
+        it->second = prio_to_elem.insert({prio, elem});
+    }
+    T extract_min(PrioType& prio)
+    {
+        const auto min_elem = prio_to_elem.begin();
+        T elem = min_elem->second;
+        prio = min_elem->first;
+        prio_to_elem.erase(min_elem);
+        elem_to_prio.erase(elem);
+        return elem;
+    }
+    std::size_t size() const {
+        return prio_to_elem.size();
+    }
+    bool empty() const {
+        return prio_to_elem.empty();
+    }
+};
+
+// Adjacency in compressed sparse row form.
+struct Graph
+{
+    std::vector<uint32_t> first_edge; // Edges of node i: [first_edge[i], first_edge[i + 1]).
+    std::vector<uint32_t> targets;
+    std::vector<int> weights;
+    int max_weight = 0;
+
+    std::size_t num_nodes() const {
+        return first_edge.size() - 1;
+    }
+};
+
+using WeightFn = std::function<int(std::mt19937&)>;
+
+Graph make_grid(int n, const WeightFn& weight, std::mt19937& rng)
+{
+    std::vector<int> cell_weights(static_cast<std::size_t>(n) * n);
+    for (int& w : cell_weights) {
+        w = weight(rng);
+    }
+    Graph graph;
+    graph.first_edge.push_back(0);
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            for (const auto& [dx, dy] : {std::pair{-1, 0}, std::pair{1, 0}, std::pair{0, -1}, std::pair{0, 1}}) {
+                if (x + dx >= 0 && x + dx < n && y + dy >= 0 && y + dy < n) {
+                    const uint32_t target = (y + dy) * n + x + dx;
+                    graph.targets.push_back(target);
+                    graph.weights.push_back(cell_weights[target]);
+                    graph.max_weight = std::max(graph.max_weight, cell_weights[target]);
+                }
+            }
+            graph.first_edge.push_back(static_cast<uint32_t>(graph.targets.size()));
+        }
+    }
+    return graph;
+}
+
+Graph make_random_graph(std::size_t num_nodes, const WeightFn& weight, std::mt19937& rng)
+{
+    constexpr int OUT_DEGREE = 4;
+    Graph graph;
+    graph.first_edge.push_back(0);
+    for (std::size_t i = 0; i < num_nodes; ++i) {
+        for (int e = 0; e < OUT_DEGREE; ++e) {
+            const uint32_t target = e == 0 ? static_cast<uint32_t>((i + 1) % num_nodes) : static_cast<uint32_t>(rng() % num_nodes);
+            graph.targets.push_back(target);
+            graph.weights.push_back(weight(rng));
+            graph.max_weight = std::max(graph.max_weight, graph.weights.back());
+        }
+        graph.first_edge.push_back(static_cast<uint32_t>(graph.targets.size()));
+    }
+    return graph;
+}
+
+struct RunStats
+{
+    int64_t checksum = 0; // Sum of all distances.
+    uint64_t ops = 0; // Queue operations.
+    std::size_t max_queue_size = 0;
+};
+
+template<typename Queue>
+RunStats dijkstra_decrease_key(const Graph& graph, Queue& queue)
+{
+    RunStats stats;
+    std::vector<int> dist(graph.num_nodes(), std::numeric_limits<int>::max());
+    if (dist.empty()) {
+        return stats;
+    }
+    dist[0] = 0;
+    queue.insert_or_update(0, 0);
+    ++stats.ops;
+    while (!queue.empty()) {
+        int d = 0;
+        const uint32_t node = queue.extract_min(d);
+        ++stats.ops;
+        stats.checksum += d;
+        for (uint32_t e = graph.first_edge[node]; e < graph.first_edge[node + 1]; ++e) {
+            const uint32_t next = graph.targets[e];
+            const int next_dist = d + graph.weights[e];
+            if (next_dist < dist[next]) {
+                dist[next] = next_dist;
+                queue.insert_or_update(next, next_dist);
+                ++stats.ops;
+                stats.max_queue_size = std::max(stats.max_queue_size, queue.size());
+            }
+        }
+    }
+    return stats;
+}
+
+RunStats dijkstra_lazy(const Graph& graph)
+{
+    using Entry = std::pair<int, uint32_t>; // {dist, node}
+    RunStats stats;
+    std::vector<int> dist(graph.num_nodes(), std::numeric_limits<int>::max());
+    if (dist.empty()) {
+        return stats;
+    }
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    dist[0] = 0;
+    queue.push({0, 0});
+    ++stats.ops;
+    while (!queue.empty()) {
+        const auto [d, node] = queue.top();
+        queue.pop();
+        ++stats.ops;
+        if (d > dist[node]) { // Stale entry.
+            continue;
+        }
+        stats.checksum += d;
+        for (uint32_t e = graph.first_edge[node]; e < graph.first_edge[node + 1]; ++e) {
+            const uint32_t next = graph.targets[e];
+            const int next_dist = d + graph.weights[e];
+            if (next_dist < dist[next]) {
+                dist[next] = next_dist;
+                queue.push({next_dist, next});
+                ++stats.ops;
+                stats.max_queue_size = std::max(stats.max_queue_size, queue.size());
+            }
+        }
+    }
+    return stats;
+}
+
+// Runs fn() (returning RunStats) and prints ns/op, the largest queue size and the peak memory allocated by fn.
+template<typename Fn>
+void run(const std::string& name, Fn fn)
+{
+    const std::size_t allocated_before = allocated_bytes;
+    peak_allocated_bytes = allocated_bytes;
+    const auto t0 = clk::now();
+    const RunStats stats = fn();
+    const auto t1 = clk::now();
+    std::cout << std::setw(10) << name << std::fixed << std::setprecision(1)
+              << std::setw(10) << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << std::setw(9) << std::chrono::duration<double, std::nano>(t1 - t0).count() / stats.ops
+              << std::setw(10) << std::setprecision(2) << stats.ops / 1e6
+              << std::setw(12) << stats.max_queue_size
+              << std::setw(11) << std::setprecision(1) << (peak_allocated_bytes - allocated_before) / (1024.0 * 1024.0)
+              << std::setw(16) << stats.checksum << "\n";
+}
+
+void run_all(const Graph& graph)
+{
+    const std::size_t num_nodes = graph.num_nodes();
+    run("multimap", [&]() {
+        MultimapPrioQueue<uint32_t> queue;
+        return dijkstra_decrease_key(graph, queue);
+    });
+    run("d=2", [&]() {
+        aocutil::PrioQueue<uint32_t, int, aocutil::FastHash<uint32_t>, 2> queue;
+        return dijkstra_decrease_key(graph, queue);
+    });
+    run("d=4", [&]() {
+        aocutil::PrioQueue<uint32_t, int> queue;
+        return dijkstra_decrease_key(graph, queue);
+    });
+    run("d=8", [&]() {
+        aocutil::PrioQueue<uint32_t, int, aocutil::FastHash<uint32_t>, 8> queue;
+        return dijkstra_decrease_key(graph, queue);
+    });
+    run("lazy", [&]() {
+        return dijkstra_lazy(graph);
+    });
+    run("radix", [&]() {
+        aocutil::RadixHeap<int> queue(num_nodes);
+        return dijkstra_decrease_key(graph, queue);
+    });
+    run("dial", [&]() {
+        aocutil::DialQueue<int> queue(num_nodes, graph.max_weight);
+        return dijkstra_decrease_key(graph, queue);
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 1024;
+    if (n < 2) {
+        std::cerr << "Usage: bench-dijkstra [n >= 2]\n";
+        return EXIT_FAILURE;
+    }
+    const std::vector<std::pair<std::string, WeightFn>> weight_fns = {
+        {"[1, 9]", [](std::mt19937& rng) { return 1 + static_cast<int>(rng() % 9); }},
+        {"{1, 1000}", [](std::mt19937& rng) { return rng() % 10 == 0 ? 1000 : 1; }},
+        {"[1, 100000]", [](std::mt19937& rng) { return 1 + static_cast<int>(rng() % 100'000); }},
+    };
+
+    std::mt19937 rng{16};
+    std::cout << std::setw(10) << "queue" << std::setw(10) << "ms" << std::setw(9) << "ns/op" << std::setw(10) << "Mops"
+              << std::setw(12) << "max size" << std::setw(11) << "peak MiB" << std::setw(16) << "checksum" << "\n";
+    for (const auto& [weights_name, weight_fn] : weight_fns) {
+        const Graph grid = make_grid(n, weight_fn, rng);
+        std::cout << "grid " << n << " x " << n << ", weights " << weights_name << "\n";
+        run_all(grid);
+    }
+    for (const auto& [weights_name, weight_fn] : weight_fns) {
+        const Graph graph = make_random_graph(static_cast<std::size_t>(n) * n, weight_fn, rng);
+        std::cout << "random graph, " << graph.num_nodes() << " nodes, " << graph.targets.size() << " edges, weights " << weights_name << "\n";
+        run_all(graph);
+    }
+    return EXIT_SUCCESS;
+}
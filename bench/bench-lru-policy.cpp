@@ -0,0 +1,142 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include "aoclib/lru-cache.hpp"
+
+/*
+    Benchmark: Hit rate and ns per access of LRUCache::get_or_compute with the different eviction policies (cf.
+    eviction-policy.hpp) on recorded key traces. The cache holds 4096 elements.
+        - zipf: 4M accesses to 100000 keys, Zipf distributed (s = 0.9), i.e. a few hot keys and a long tail.
+        - hot+scan: 4M accesses, 2/3 to a hot set of 3072 keys, 1/3 to a sequential scan of keys which are never used again
+          (the workload scan-resistant policies are made for: The hot set fits into the cache, but LRU lets the scan flush it).
+        - loop: 4M accesses cycling through 4915 keys (1.2 times the capacity; LRU always evicts the key needed next).
+        - blink: The lookups of the memoised recursion of day 11 (len_after_blinks, 75 blinks of the stones 1 to 200),
+          recorded with an unbounded cache and replayed.
+    Run with: cmake --build build/Release --target run-bench-lru-policy
+*/
+
+using clk = std::chrono::steady_clock;
+using aocutil::EvictionPolicy;
+constexpr std::size_t CAPACITY = 4096;
+constexpr int NUM_ACCESSES = 4'000'000;
+
+std::vector<uint64_t> zipf_trace(std::mt19937_64& rng)
+{
+    constexpr int NUM_KEYS = 100'000;
+    constexpr double S = 0.9;
+    std::vector<double> cdf(NUM_KEYS);
+    double sum = 0;
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        sum += 1.0 / std::pow(i + 1, S);
+        cdf[i] = sum;
+    }
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<uint64_t> keys(NUM_ACCESSES);
+    for (uint64_t& key : keys) {
+        key = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    }
+    return keys;
+}
+
+std::vector<uint64_t> hot_scan_trace(std::mt19937_64& rng)
+{
+    constexpr uint64_t HOT_KEYS = CAPACITY * 3 / 4;
+    uint64_t next_scan_key = HOT_KEYS;
+    std::vector<uint64_t> keys(NUM_ACCESSES);
+    for (uint64_t& key : keys) {
+        key = rng() % 3 == 0 ? next_scan_key++ : rng() % HOT_KEYS;
+    }
+    return keys;
+}
+
+std::vector<uint64_t> loop_trace()
+{
+    constexpr uint64_t LOOP_KEYS = CAPACITY * 6 / 5;
+    std::vector<uint64_t> keys(NUM_ACCESSES);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = i % LOOP_KEYS;
+    }
+    return keys;
+}
+
+// Lookups of day 11's len_after_blinks (keys: stone * 128 + blinks).
+std::vector<uint64_t> blink_trace()
+{
+    std::vector<uint64_t> keys;
+    aocutil::FlatMap<uint64_t, int64_t> memo;
+    std::function<int64_t(int64_t, int)> len_after_blinks = [&](int64_t stone, int blinks) -> int64_t {
+        if (blinks == 0) {
+            return 1;
+        }
+        const uint64_t key = static_cast<uint64_t>(stone) * 128 + blinks;
+        keys.push_back(key);
+        if (const auto it = memo.find(key); it != memo.end()) {
+            return it->second;
+        }
+        int64_t result = 0;
+        if (stone == 0) {
+            result = len_after_blinks(1, blinks - 1);
+        } else if (const std::string digits = std::to_string(stone); digits.size() % 2 == 0) {
+            result = len_after_blinks(std::stoll(digits.substr(0, digits.size() / 2)), blinks - 1) + len_after_blinks(std::stoll(digits.substr(digits.size() / 2)), blinks - 1);
+        } else {
+            result = len_after_blinks(stone * 2024, blinks - 1);
+        }
+        memo.insert({key, result});
+        return result;
+    };
+    for (int64_t stone = 1; stone <= 200; ++stone) {
+        len_after_blinks(stone, 75);
+    }
+    return keys;
+}
+
+uint64_t compute(uint64_t key)
+{
+    return key * 0x9E3779B97F4A7C15ull;
+}
+
+template<EvictionPolicy policy>
+void run(const std::vector<uint64_t>& keys)
+{
+    aocutil::LRUCache<uint64_t, uint64_t, 0, aocutil::FastHash<uint64_t>, policy> cache(CAPACITY);
+    uint64_t misses = 0, checksum = 0;
+    const auto t0 = clk::now();
+    for (uint64_t k : keys) {
+        checksum += cache.get_or_compute(k, [k, &misses]() { ++misses; return compute(k); });
+    }
+    const auto t1 = clk::now();
+    if (checksum == 0) {
+        std::cout << "?"; // Keeps the loop from being optimised out.
+    }
+    std::cout << std::fixed << std::setprecision(3) << std::setw(8) << 1.0 - static_cast<double>(misses) / keys.size()
+              << std::setprecision(1) << std::setw(7) << std::chrono::duration<double, std::nano>(t1 - t0).count() / keys.size();
+}
+
+int main()
+{
+    std::mt19937_64 rng{42};
+    const std::vector<std::pair<std::string, std::vector<uint64_t>>> traces = {
+        {"zipf", zipf_trace(rng)}, {"hot+scan", hot_scan_trace(rng)}, {"loop", loop_trace()}, {"blink", blink_trace()}
+    };
+
+    std::cout << std::setw(10) << "" << std::setw(10) << "accesses";
+    for (const char* name : {"LRU", "Clock", "2Q", "ARC"}) {
+        std::cout << std::setw(8) << name << std::setw(7) << "ns/op";
+    }
+    std::cout << "\n";
+    for (const auto& [name, keys] : traces) {
+        std::cout << std::setw(10) << name << std::setw(10) << keys.size();
+        run<EvictionPolicy::LRU>(keys);
+        run<EvictionPolicy::Clock>(keys);
+        run<EvictionPolicy::TwoQ>(keys);
+        run<EvictionPolicy::ARC>(keys);
+        std::cout << "\n";
+    }
+    return EXIT_SUCCESS;
+}
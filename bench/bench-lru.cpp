@@ -0,0 +1,206 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include "aoclib/lru-cache.hpp"
+#include "aoclib/sharded-lru-cache.hpp"
+
+/*
+    Benchmark: LRUCache lookup/insertion APIs on key streams with different hit rates (ns per access):
+        - list+umap: The textbook LRU cache (std::list + std::unordered_map of list iterators) as a baseline.
+        - get+insert: get_copy, and insert on a miss (one lookup on a hit, two on a miss).
+        - get_or_compute: Same lookups as get+insert, but the value is constructed in place.
+        - try_emplace: One lookup for hits and misses alike (the value is passed in, so it is constructed for hits as well).
+        - move-only: get_or_compute with std::unique_ptr values (the evicted node's pointer is reused by move assignment).
+    The cache holds 4096 elements, the keys are drawn uniformly from a range of 4300, 8192 or 80000 keys.
+    Threaded part: Accesses per µs (summed over all threads) on a hit-only workload (the keys fit into the cache), for
+        - global lock: One LRUCache behind one std::mutex.
+        - sharded: ShardedLRUCache::get_or_compute (64 shards).
+        - sharded peek: ShardedLRUCache::peek (the relaxed read path).
+        - rw peek: ShardedLRUCache::peek with std::shared_mutex (concurrent peeks of a shard don't wait for each other).
+      contended: Lock acquisitions of the sharded cache which had to wait (per 1000 accesses).
+    Run with: cmake --build build/Release --target run-bench-lru
+*/
+
+using clk = std::chrono::steady_clock;
+constexpr std::size_t CAPACITY = 4096;
+constexpr int NUM_ACCESSES = 4'000'000;
+
+struct ListLRU
+{
+    using Entry = std::pair<int, int64_t>;
+    std::list<Entry> entries; // Most recently used first.
+    std::unordered_map<int, std::list<Entry>::iterator> map;
+
+    int64_t get_or_compute(int key, auto fn)
+    {
+        if (const auto it = map.find(key); it != map.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+        if (entries.size() == CAPACITY) {
+            map.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, fn());
+        map.emplace(key, entries.begin());
+        return entries.front().second;
+    }
+};
+
+int64_t compute(int key)
+{
+    return static_cast<int64_t>(key) * key;
+}
+
+template<typename Fn>
+void run(const std::string& name, const std::vector<int>& keys, Fn fn)
+{
+    const auto t0 = clk::now();
+    const int64_t checksum = fn(keys);
+    const auto t1 = clk::now();
+    std::cout << std::setw(18) << name << std::fixed << std::setprecision(1)
+              << std::setw(10) << std::chrono::duration<double, std::nano>(t1 - t0).count() / keys.size()
+              << std::setw(22) << checksum << "\n";
+}
+
+// Runs fn(thread_idx, keys) on num_threads threads at once; returns the accesses per µs.
+template<typename Fn>
+double accesses_per_us(int num_threads, const std::vector<int>& keys, Fn fn)
+{
+    std::vector<std::thread> threads;
+    const auto t0 = clk::now();
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(fn, i, std::cref(keys));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const auto t1 = clk::now();
+    return static_cast<double>(num_threads) * keys.size() / std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+void run_threaded()
+{
+    constexpr int ACCESSES_PER_THREAD = 1'000'000;
+    std::mt19937 rng{7};
+    std::vector<int> keys(ACCESSES_PER_THREAD);
+    for (int& key : keys) {
+        key = static_cast<int>(rng() % (CAPACITY / 2));
+    }
+
+    std::cout << "\n" << std::setw(8) << "threads" << std::setw(14) << "global lock" << std::setw(10) << "sharded" << std::setw(14) << "sharded peek" << std::setw(10) << "rw peek" << std::setw(11) << "contended" << "\n";
+    for (int num_threads : {1, 2, 4, 8, 16}) {
+        std::mutex global_mutex;
+        aocutil::LRUCache<int, int64_t> global_cache(CAPACITY);
+        const double global = accesses_per_us(num_threads, keys, [&](int, const std::vector<int>& ks) {
+            int64_t sum = 0;
+            for (int k : ks) {
+                std::lock_guard guard{global_mutex};
+                sum += global_cache.get_or_compute(k, [k]() { return compute(k); });
+            }
+            return sum;
+        });
+
+        aocutil::ShardedLRUCache<int, int64_t> sharded_cache(CAPACITY, 64);
+        const double sharded = accesses_per_us(num_threads, keys, [&](int, const std::vector<int>& ks) {
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += sharded_cache.get_or_compute(k, [k]() { return compute(k); });
+            }
+            return sum;
+        });
+        const aocutil::ShardStats stats = sharded_cache.stats();
+        const double peek = accesses_per_us(num_threads, keys, [&](int, const std::vector<int>& ks) {
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += sharded_cache.peek(k).value_or(0);
+            }
+            return sum;
+        });
+
+        aocutil::ShardedLRUCache<int, int64_t, aocutil::FastHash<int>, std::shared_mutex> rw_cache(CAPACITY, 64);
+        for (int k : keys) {
+            rw_cache.try_emplace(k, compute(k));
+        }
+        const double rw_peek = accesses_per_us(num_threads, keys, [&](int, const std::vector<int>& ks) {
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += rw_cache.peek(k).value_or(0);
+            }
+            return sum;
+        });
+
+        std::cout << std::setw(8) << num_threads << std::fixed << std::setprecision(1) << std::setw(14) << global << std::setw(10) << sharded
+                  << std::setw(14) << peek << std::setw(10) << rw_peek << std::setw(11) << std::setprecision(2) << 1000.0 * stats.contended / (stats.hits + stats.misses) << "\n";
+    }
+}
+
+int main()
+{
+    std::cout << std::setw(18) << "api" << std::setw(10) << "ns/op" << std::setw(22) << "checksum" << "\n";
+    std::mt19937 rng{42};
+    for (int key_range : {4300, 8192, 80'000}) {
+        std::vector<int> keys(NUM_ACCESSES);
+        for (int& key : keys) {
+            key = static_cast<int>(rng() % key_range);
+        }
+        std::cout << "keys in [0, " << key_range << "), hit rate ~" << std::setprecision(2) << std::min(1.0, static_cast<double>(CAPACITY) / key_range) << "\n";
+
+        run("list+umap", keys, [](const std::vector<int>& ks) {
+            ListLRU cache;
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += cache.get_or_compute(k, [k]() { return compute(k); });
+            }
+            return sum;
+        });
+        run("get+insert", keys, [](const std::vector<int>& ks) {
+            aocutil::LRUCache<int, int64_t> cache(CAPACITY);
+            int64_t sum = 0;
+            for (int k : ks) {
+                if (const auto val = cache.get_copy(k)) {
+                    sum += *val;
+                } else {
+                    cache.insert(k, compute(k));
+                    sum += compute(k);
+                }
+            }
+            return sum;
+        });
+        run("get_or_compute", keys, [](const std::vector<int>& ks) {
+            aocutil::LRUCache<int, int64_t> cache(CAPACITY);
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += cache.get_or_compute(k, [k]() { return compute(k); });
+            }
+            return sum;
+        });
+        run("try_emplace", keys, [](const std::vector<int>& ks) {
+            aocutil::LRUCache<int, int64_t> cache(CAPACITY);
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += *cache.try_emplace(k, compute(k)).first;
+            }
+            return sum;
+        });
+        run("move-only", keys, [](const std::vector<int>& ks) {
+            aocutil::LRUCache<int, std::unique_ptr<int64_t>> cache(CAPACITY);
+            int64_t sum = 0;
+            for (int k : ks) {
+                sum += *cache.get_or_compute(k, [k]() { return std::make_unique<int64_t>(compute(k)); });
+            }
+            return sum;
+        });
+    }
+
+    run_threaded();
+    return EXIT_SUCCESS;
+}
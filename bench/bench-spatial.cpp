@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <limits>
+#include "aoclib/vec.hpp"
+#include "aoclib/spatial-index.hpp"
+
+/*
+    Benchmark: Build and query times of the spatial indices (aoclib/spatial-index.hpp) compared with brute force
+    (comparing the query point with every point, like the pairwise loops in day 8):
+        - build: ms to build the index over all points.
+        - radius: ns per count_radius query (Euclidean, radius 3).
+        - nearest: ns per nearest query.
+    Workloads: points spread uniformly over a grid, and the same number of points in a few tight clusters (robot crowds).
+    Run with: cmake --build build/Release --target run-bench-spatial
+*/
+
+using Vec2 = aocutil::Vec2<int>;
+using clk = std::chrono::steady_clock;
+
+struct Workload
+{
+    std::string name;
+    std::vector<Vec2> points;
+    std::vector<Vec2> queries;
+};
+
+std::vector<Workload> workloads()
+{
+    std::mt19937 rng{14};
+    std::vector<Workload> result;
+    for (int n : {500, 20'000}) {
+        const int side = n == 500 ? 101 : 1000;
+        Workload uniform{.name = "uniform " + std::to_string(n), .points = {}, .queries = {}};
+        Workload clustered{.name = "clustered " + std::to_string(n), .points = {}, .queries = {}};
+        for (int i = 0; i < n; ++i) {
+            uniform.points.push_back({static_cast<int>(rng() % side), static_cast<int>(rng() % side)});
+            const Vec2 cluster_centre = {static_cast<int>(side / 8 * (1 + i % 4)), static_cast<int>(side / 8 * (1 + i % 3))};
+            clustered.points.push_back(cluster_centre + Vec2{static_cast<int>(rng() % 11) - 5, static_cast<int>(rng() % 11) - 5});
+        }
+        for (int i = 0; i < 10'000; ++i) {
+            const Vec2 q = {static_cast<int>(rng() % side), static_cast<int>(rng() % side)};
+            uniform.queries.push_back(q);
+            clustered.queries.push_back(q);
+        }
+        result.push_back(std::move(uniform));
+        result.push_back(std::move(clustered));
+    }
+    return result;
+}
+
+struct BruteForce
+{
+    std::vector<Vec2> points_;
+
+    explicit BruteForce(std::span<const Vec2> points) : points_(points.begin(), points.end()) {}
+
+    int count_radius(const Vec2& centre, int radius, aocutil::Metric metric) const
+    {
+        int count = 0;
+        for (const Vec2& p : points_) {
+            count += aocutil::spatial_impl::dist(metric, p, centre) <= aocutil::spatial_impl::dist_of_gap<int>(metric, radius);
+        }
+        return count;
+    }
+
+    std::optional<int> nearest(const Vec2& q, aocutil::Metric metric) const
+    {
+        int best = -1;
+        int64_t best_dist = std::numeric_limits<int64_t>::max();
+        for (int i = 0; i < std::ssize(points_); ++i) {
+            const int64_t d = aocutil::spatial_impl::dist(metric, points_[i], q);
+            if (d < best_dist) {
+                best_dist = d, best = i;
+            }
+        }
+        return best == -1 ? std::nullopt : std::optional<int>(best);
+    }
+};
+
+template<typename Index>
+void run(const Workload& w, const std::string& index_name)
+{
+    const auto t0 = clk::now();
+    const Index index(w.points);
+    const auto t1 = clk::now();
+    int64_t checksum = 0;
+    for (const Vec2& q : w.queries) {
+        checksum += index.count_radius(q, 3, aocutil::Metric::Euclidean);
+    }
+    const auto t2 = clk::now();
+    for (const Vec2& q : w.queries) {
+        checksum += aocutil::spatial_impl::dist(aocutil::Metric::Euclidean, w.points.at(index.nearest(q, aocutil::Metric::Euclidean).value()), q); // Distances, since ties may be broken differently.
+    }
+    const auto t3 = clk::now();
+
+    const auto ns_per_query = [&w](clk::time_point a, clk::time_point b) {
+        return std::chrono::duration<double, std::nano>(b - a).count() / w.queries.size();
+    };
+    std::cout << std::left << std::setw(18) << w.name << std::setw(12) << index_name << std::right << std::fixed
+              << std::setw(10) << std::setprecision(3) << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << std::setw(10) << std::setprecision(1) << ns_per_query(t1, t2) << std::setw(10) << ns_per_query(t2, t3)
+              << std::setw(14) << checksum << "\n";
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(18) << "workload" << std::setw(12) << "index" << std::right
+              << std::setw(10) << "build" << std::setw(10) << "radius" << std::setw(10) << "nearest" << std::setw(14) << "checksum" << "\n";
+    for (const auto& w : workloads()) {
+        run<BruteForce>(w, "brute force");
+        run<aocutil::BucketGrid<int>>(w, "BucketGrid");
+        run<aocutil::KDTree<int>>(w, "KDTree");
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,7 +1,7 @@
 #include <algorithm>
 #include <numeric>
-#include <unordered_map>
 #include "aoclib/aocio.hpp"
+#include "aoclib/dense-map.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/1
@@ -48,19 +48,18 @@ int part_two(const std::vector<std::string>& lines)
     std::vector<int> id_1, id_2; 
     parse_lists(lines, id_1, id_2); 
 
-    std::unordered_map<int, int> count; 
-    for (int id : id_2) {
-        if (count.contains(id)) {
-            count.at(id) += 1; 
-        } else {
-            count.insert({id, 1});
-        }
-    }
-
+    auto count = aocutil::AdaptiveMap<int, int>::for_keys(id_2); // Five-digit IDs: Direct-addressed if there are enough of them, hashed otherwise.
     int score = 0; 
-    for (int id : id_1) {
-        score += id * (count.contains(id) ? count.at(id) : 0); 
-    }
+    count.visit([&id_1, &id_2, &score](auto& map) {
+        for (int id : id_2) {
+            map[id] += 1; 
+        }
+        for (int id : id_1) {
+            if (const auto it = map.find(id); it != map.end()) {
+                score += id * it->second; 
+            }
+        }
+    });
     return score;
 }
 
@@ -1,6 +1,7 @@
-#include <numeric>
+#include <string_view>
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
+#include "aoclib/stencil.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/4
@@ -11,6 +12,7 @@
     Notes:  
         - Part 1: 
         - Part 2:
+        - Both parts are evaluated as stencils over the whole grid (cf. aoclib/stencil.hpp) instead of per-cell try_get calls.
 */
 
 using aocutil::Grid;
@@ -19,45 +21,27 @@ using Vec2 = aocutil::Vec2<int>;
 int part_one(const std::vector<std::string>& lines, bool part_two = false)
 {
     const Grid<char> grid{lines}; 
-    const std::vector<Vec2> candidates = grid.find_elem_positions(part_two ? 'A' : 'X');
+    using Stencil = aocutil::Stencil<char>;
 
-    const auto match_xmas = [&grid](const Vec2& pos) -> int { // For Part 1. 
-        const std::string XMAS_STR = "XMAS";
-        const std::array<Vec2, 8> directions = aocutil::all_dirs_plus_diagonals_vec2<int>();
-        int matched_xmas = 0; 
-        for (const Vec2& direction : directions) {
-            int valid_chars = 0;  
-            for (int n = 0; n < std::ssize(XMAS_STR); ++n) {
-                if (const auto& ch = grid.try_get(pos + n * direction); ch.has_value() && ch.value() == XMAS_STR.at(n)) {
-                    ++valid_chars;
-                } else {
-                    break;
-                }
-            }
-            matched_xmas += valid_chars == std::ssize(XMAS_STR) ? 1 : 0;
-        } 
-        return matched_xmas;
-    };
-
-    const auto match_cross_mas = [&grid](const Vec2& pos) -> int { // For Part 2. 
-        const std::array<std::pair<Vec2, Vec2>, 2> cross_dirs = {std::make_pair(Vec2{1, -1}, Vec2{-1, 1}), std::make_pair(Vec2{-1, -1}, Vec2{1, 1})};
-        for (const auto& dir_pair : cross_dirs) {
-            const auto ch_top = grid.try_get(pos + dir_pair.first); 
-            const auto ch_bottom = grid.try_get(pos + dir_pair.second);
-            if (!ch_top.has_value() || !ch_bottom.has_value()) {
-                return 0; 
-            }
-            const bool mas_cross = (ch_top.value() == 'M' && ch_bottom.value() == 'S') || (ch_top.value() == 'S' && ch_bottom.value() == 'M');
-            if (!mas_cross) {
-                return 0;
-            }
+    std::vector<Stencil> stencils;
+    if (!part_two) { // Part 1: "XMAS" in each of the 8 directions.
+        constexpr std::string_view XMAS_STR = "XMAS";
+        for (const Vec2& direction : aocutil::all_dirs_plus_diagonals_vec2<int>()) {
+            stencils.push_back(Stencil::sequence(XMAS_STR, direction));
         }
-        return 1;
-    };
-
-    return std::reduce(candidates.cbegin(), candidates.cend(), 0, [&](int result, const Vec2& pos) {
-        return result + (part_two ? match_cross_mas(pos) : match_xmas(pos));
-    });
+    } else { // Part 2: The four orientations of two "MAS" crossing at their 'A'.
+        const std::array<Vec2, 4> corners = {Vec2{-1, -1}, Vec2{1, -1}, Vec2{1, 1}, Vec2{-1, 1}}; // Clockwise.
+        for (int rot = 0; rot < 4; ++rot) { // Two adjacent corners are 'M', the opposite two are 'S'.
+            stencils.push_back(Stencil{
+                {.offset = {0, 0}, .value = 'A'},
+                {.offset = corners.at(rot), .value = 'M'},
+                {.offset = corners.at((rot + 1) % 4), .value = 'M'},
+                {.offset = corners.at((rot + 2) % 4), .value = 'S'},
+                {.offset = corners.at((rot + 3) % 4), .value = 'S'},
+            });
+        }
+    }
+    return aocutil::stencil_count<char>(grid, stencils, '.');
 }
 
 int part_two(const std::vector<std::string>& lines)
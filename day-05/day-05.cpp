@@ -1,8 +1,7 @@
-#include <unordered_map>
-#include <unordered_set>
 #include <numeric>
 #include <algorithm>
 #include "aoclib/aocio.hpp"
+#include "aoclib/dense-map.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/5
@@ -15,8 +14,9 @@
         - Part 2: I think I initally had a bug in Part 2, but the solution was correct anyways. Fixed the bug now.  
 */
 
-void parse_input(const std::vector<std::string>& lines, std::unordered_map<int, std::unordered_set<int>>& ordering_rules, std::vector<std::vector<int>>& updates)
+void parse_input(const std::vector<std::string>& lines, aocutil::DenseMap<int, aocutil::DenseSet<int>>& ordering_rules, std::vector<std::vector<int>>& updates)
 {
+    std::vector<std::pair<int, int>> rules; // {before, after}
     bool first_section = true;
     for (const auto& line: lines) {
         if (aocio::str_without_whitespace(line) == "") { 
@@ -32,11 +32,7 @@ void parse_input(const std::vector<std::string>& lines, std::unordered_map<int,
              // after -> [before_1, before_2, ...]
             int before = aocio::parse_num(toks.at(0)).value();
             int after = aocio::parse_num(toks.at(1)).value();
-            if (ordering_rules.contains(after)) {
-                ordering_rules.at(after).insert(before); 
-            } else {
-                ordering_rules.insert({after, std::unordered_set<int>{before}});
-            }
+            rules.push_back({before, after});
         } else { // 2.) Parse the page numbers of each update.
             std::vector<std::string> toks;
             aocio::line_tokenise(line, ",", "", toks);
@@ -52,11 +48,25 @@ void parse_input(const std::vector<std::string>& lines, std::unordered_map<int,
     if (!updates.size()) {
         throw std::invalid_argument("parse_input: Input contains no updates.");
     }
+
+    // Page numbers are two-digit: Direct-address tables over the range of the pages in the rules instead of hash maps.
+    int min_page = std::numeric_limits<int>::max(), max_page = std::numeric_limits<int>::min();
+    for (const auto& [before, after] : rules) {
+        min_page = std::min({min_page, before, after});
+        max_page = std::max({max_page, before, after});
+    }
+    if (rules.empty()) {
+        min_page = max_page = 0;
+    }
+    ordering_rules = aocutil::DenseMap<int, aocutil::DenseSet<int>>(min_page, max_page, aocutil::DenseSet<int>(min_page, max_page));
+    for (const auto& [before, after] : rules) {
+        ordering_rules[after].insert(before); 
+    }
 }
 
 int part_one(const std::vector<std::string>& lines)
 {
-    std::unordered_map<int, std::unordered_set<int>> ordering_rules; // page_n -> [before_1, before_2, ...]
+    aocutil::DenseMap<int, aocutil::DenseSet<int>> ordering_rules; // page_n -> [before_1, before_2, ...]
     std::vector<std::vector<int>> updates; 
     parse_input(lines, ordering_rules, updates);
     int sum_of_middle_pages = 0;
@@ -64,8 +74,8 @@ int part_one(const std::vector<std::string>& lines)
     for (const auto& pages : updates) {
         for (auto it = pages.cbegin(); it != pages.cend(); ++it) {
             const int page = *it;
-            if (ordering_rules.contains(page)) { // The current page has "prerequisites" (pages which must come before it).
-                const std::unordered_set<int>& before = ordering_rules.at(page); 
+            if (const auto rule = ordering_rules.find(page); rule != ordering_rules.end()) { // The current page has "prerequisites" (pages which must come before it).
+                const aocutil::DenseSet<int>& before = rule->second; 
                 for (auto after_it = it; after_it != pages.cend(); ++after_it) { // Note: O(n^2) time complexity...
                     if (before.contains(*after_it)) { // A page which must come before the current page actually comes after it -> violation of the ordering rules.
                         goto next;
@@ -85,7 +95,7 @@ int part_one(const std::vector<std::string>& lines)
 
 int part_two(const std::vector<std::string>& lines)
 {
-    std::unordered_map<int, std::unordered_set<int>> ordering_rules; // page_n -> [before_1, before_2, ...]
+    aocutil::DenseMap<int, aocutil::DenseSet<int>> ordering_rules; // page_n -> [before_1, before_2, ...]
     std::vector<std::vector<int>> updates; 
     parse_input(lines, ordering_rules, updates);
     int sum_of_middle_pages = 0;
@@ -95,8 +105,8 @@ int part_two(const std::vector<std::string>& lines)
         for (auto it = pages.begin(); it != pages.end();) {
             const int page = *it;
             bool did_swap = false;
-            if (ordering_rules.contains(page)) { // The current page has "prerequisites" (pages which must come before it).
-                const std::unordered_set<int>& before = ordering_rules.at(page); 
+            if (const auto rule = ordering_rules.find(page); rule != ordering_rules.end()) { // The current page has "prerequisites" (pages which must come before it).
+                const aocutil::DenseSet<int>& before = rule->second; 
                 auto current_page_it = it;
                 for (auto after_it = it + 1; after_it != pages.end(); ++after_it) { // Note: O(n^2) time complexity...
                     if (before.contains(*after_it)) { // A page which must come before the current page actually comes after it -> violation of the ordering rules.
@@ -1,6 +1,7 @@
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
 #include "aoclib/parallel.hpp"
+#include "aoclib/ray-index.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/6
@@ -73,6 +74,38 @@ bool guard_wander(const Grid<char>& grid, Grid<uint8_t>& visited_grid, const Vec
     return true; // Guard did not get caught in a loop.
 }
 
+/*
+    Part 2: Instead of stepping cell by cell, jump straight to the cell in front of the next obstacle (GridRayIndex). 
+    A loop means the guard turns at the same position in the same direction twice, so we only need flags for the turning positions.
+*/
+bool guard_wander_jumping(const aocutil::GridRayIndex& obstacles, Grid<uint8_t>& turn_grid, std::vector<Vec2>& turn_positions, const Vec2& start_pos)
+{
+    for (const Vec2& pos : turn_positions) { // Only reset the flags we set in the previous run (instead of the whole grid).
+        turn_grid.at(pos) = DIR_NONE;
+    }
+    turn_positions.clear();
+
+    Vec2 guard_pos = start_pos;
+    Direction guard_dir = Direction::Up;
+
+    while (true) {
+        const auto obstacle_dist = obstacles.hit_distance(guard_pos, guard_dir);
+        if (!obstacle_dist.has_value()) {
+            return true; // Guard left the grid, i.e. did not get caught in a loop.
+        }
+        guard_pos += aocutil::dir_to_vec2<int>(guard_dir) * (obstacle_dist.value() - 1);
+
+        uint8_t& turn_flags = turn_grid.at(guard_pos);
+        if (turn_flags & dir_to_flag(guard_dir)) { // Already turned here coming from the current direction:
+            return false; // -> Guard got caught in a loop.
+        } else if (!turn_flags) {
+            turn_positions.push_back(guard_pos);
+        }
+        turn_flags |= dir_to_flag(guard_dir);
+        guard_dir = aocutil::dir_get_left_right(guard_dir).second; // Turn right.
+    }
+}
+
 int part_one(const std::vector<std::string>& lines, bool part_two = false)
 {
     Grid<char> grid{lines}; 
@@ -93,26 +126,33 @@ int part_one(const std::vector<std::string>& lines, bool part_two = false)
     // Optimisation #2: Only consider potential obstacles in the guard's initial path.
     const std::vector<Vec2> candidates = visited_grid.find_elem_positions_if([](uint8_t flag) -> bool { return flag != DIR_NONE; }); 
 
+    // Optimisation #3: Jump from obstacle to obstacle (only the row and column of the new obstruction have to be updated in the index).
+    const aocutil::GridRayIndex obstacles(grid, [](char c) { return c == '#'; });
+
     constexpr int NUM_THREADS = 4;
 
     if (NUM_THREADS <= 1) {
+        aocutil::GridRayIndex obstacles_tmp {obstacles};
+        Grid<uint8_t> turn_grid(grid.width(), grid.height(), DIR_NONE);
+        std::vector<Vec2> turn_positions;
         int num_obstructions = 0; 
         for (const Vec2& obstruction_pos : candidates) {
             if (obstruction_pos == start_pos) { // Don't drop obstacles on the guard...
                 continue;
             }
-            grid.set(obstruction_pos, '#');
-            num_obstructions += guard_wander(grid, visited_grid, start_pos) ? 0 : 1;
-            grid.set(obstruction_pos, '.');
+            obstacles_tmp.set_hit(obstruction_pos, true);
+            num_obstructions += guard_wander_jumping(obstacles_tmp, turn_grid, turn_positions, start_pos) ? 0 : 1;
+            obstacles_tmp.set_hit(obstruction_pos, false);
         }
         return num_obstructions;
     }
 
     // Threading solution for practice; not really worth it performance wise (release: from ~0.3s to ~0.17s, debug: from ~9.5s to ~5.3s; with NUM_THREADS = 4 on my laptop).  
       
-    const auto valid_obstructions = [&grid = std::as_const(grid), &start_pos](std::vector<Vec2>::const_iterator cbegin, std::vector<Vec2>::const_iterator cend) -> int {
-        Grid<char> grid_tmp {grid};
-        Grid<uint8_t> visited_grid_tmp(grid_tmp.width(), grid_tmp.height(), DIR_NONE);
+    const auto valid_obstructions = [&obstacles, &start_pos, &grid = std::as_const(grid)](std::vector<Vec2>::const_iterator cbegin, std::vector<Vec2>::const_iterator cend) -> int {
+        aocutil::GridRayIndex obstacles_tmp {obstacles};
+        Grid<uint8_t> turn_grid_tmp(grid.width(), grid.height(), DIR_NONE);
+        std::vector<Vec2> turn_positions_tmp;
         // aocutil::threadsafe_log("Worker thread spawned...\n");
         int num_obstructions = 0; 
         for (auto pos_it = cbegin; pos_it != cend; ++pos_it) {
@@ -120,9 +160,9 @@ int part_one(const std::vector<std::string>& lines, bool part_two = false)
             if (obstruction_pos == start_pos) { // Don't drop obstacles on the guard...
                 continue;
             }
-            grid_tmp.set(obstruction_pos, '#');
-            num_obstructions += guard_wander(grid_tmp, visited_grid_tmp, start_pos) ? 0 : 1;
-            grid_tmp.set(obstruction_pos, '.');
+            obstacles_tmp.set_hit(obstruction_pos, true);
+            num_obstructions += guard_wander_jumping(obstacles_tmp, turn_grid_tmp, turn_positions_tmp, start_pos) ? 0 : 1;
+            obstacles_tmp.set_hit(obstruction_pos, false);
         }
         return num_obstructions;
     };
@@ -1,8 +1,8 @@
-#include <unordered_map>
-#include <unordered_set>
 #include <ranges>
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
+#include "aoclib/flat-hash.hpp"
+#include "aoclib/dense-map.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/8
@@ -21,18 +21,14 @@ using aocutil::Grid;
 int part_one(const std::vector<std::string>& lines, bool is_part_two = false)
 {
     const Grid<char> grid {lines};
-    std::unordered_map<char, std::vector<Vec2>> antenna_positions; // {antenna_type_xy -> [pos_1, ..., pos_n], ...}
-    std::unordered_set<Vec2> antinode_positions;
+    aocutil::DenseMap<char, std::vector<Vec2>> antenna_positions {std::numeric_limits<char>::min(), std::numeric_limits<char>::max()}; // {antenna_type_xy -> [pos_1, ..., pos_n], ...}
+    aocutil::FlatSet<Vec2> antinode_positions;
 
     grid.foreach([&antenna_positions](const Vec2& pos, char elem) {
         if (elem == '.') {
             return;
         }
-        if (antenna_positions.contains(elem)) {
-            antenna_positions.at(elem).push_back(pos);
-        } else {
-            antenna_positions.insert({elem, std::vector<Vec2>{pos}});
-        }
+        antenna_positions[elem].push_back(pos);
     });
     
     const auto handle_pair_p1 = [&grid, &antinode_positions](const Vec2& a, const Vec2& b) {
@@ -2,6 +2,7 @@
 #include <numeric>
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
+#include "aoclib/padded-grid.hpp"
 #include "aoclib/vec.hpp"
 
 /*
@@ -33,36 +34,28 @@ int part_one(const std::vector<std::string>& lines, bool part_two = false)
         height_map.push_row(row);
     }
 
-    const auto get_adjacent = [&height_map = std::as_const(height_map)](const Vec2& pos) {
-        const auto dirs = aocutil::all_dirs_vec2<int>(); 
-        std::vector<Vec2> neighbors; 
-        for (const auto dir : dirs) {
-            if (height_map.try_get(pos + dir).has_value()) {
-                neighbors.push_back(pos + dir);
-            }
-        }
-        return neighbors; 
-    };
+    const aocutil::PaddedGrid<int> heights(height_map, -1); // The border of -1 is never "current height + 1", so no bounds checks are needed.
+    using idx_t = aocutil::PaddedGrid<int>::idx_t;
 
-    const auto trailhead_score = [&height_map = std::as_const(height_map), &get_adjacent, part_two](const Vec2& trailhead) -> int {
+    const auto trailhead_score = [&heights, part_two](idx_t trailhead) -> int {
         int score = 0;
-        std::stack<Vec2> positions; 
+        std::stack<idx_t> positions; 
         positions.push(trailhead);
-        Grid<bool> reached(height_map.width(), height_map.height(), false);
+        std::vector<uint8_t> reached(heights.size(), false);
 
         while (!positions.empty()) { // Depth-first search.
-            const Vec2 pos = positions.top(); 
+            const idx_t idx = positions.top(); 
             positions.pop();
-            const auto current_height = height_map.get(pos);
-            std::vector<Vec2> adjacent = get_adjacent(pos); 
-            for (const auto& adj_pos : adjacent) {
-                const auto neighbor_height = height_map.get(adj_pos); 
+            const int current_height = heights[idx];
+            for (const idx_t offset : heights.offsets4()) {
+                const idx_t adj_idx = idx + offset;
+                const int neighbor_height = heights[adj_idx]; 
                 if (neighbor_height == current_height + 1) {
-                    if (neighbor_height == 9 && !reached.get(adj_pos)) {
-                        reached.set(adj_pos, !part_two); // Only use the "reached" grid for Part 1 (i.e. count all paths for Part 2)
+                    if (neighbor_height == 9 && !reached[adj_idx]) {
+                        reached[adj_idx] = !part_two; // Only use the "reached" grid for Part 1 (i.e. count all paths for Part 2)
                         ++score;
                     } else {
-                        positions.push(adj_pos); 
+                        positions.push(adj_idx); 
                     }
                 }
             }
@@ -70,7 +63,7 @@ int part_one(const std::vector<std::string>& lines, bool part_two = false)
         return score;
     }; 
 
-    const std::vector<Vec2> trailheads = height_map.find_elem_positions_if([](auto h) {return h == 0;}); 
+    const std::vector<idx_t> trailheads = heights.find_elem_indices(0); 
     return std::transform_reduce(trailheads.cbegin(), trailheads.cend(), int{0}, std::plus{}, trailhead_score);
 }
 
@@ -3,6 +3,7 @@
 #include <unordered_set>
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
+#include "aoclib/stencil.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/12
@@ -23,7 +24,7 @@ struct Plot {
     int num_fences = 4; 
 };
 
-int region_price(const Grid<char>& grid, Grid<int>& visited, const Vec2& pos, bool discount = false)
+int region_price(const Grid<char>& grid, const Grid<int>& fences, Grid<int>& visited, const Vec2& pos, bool discount = false)
 {
     const char plant_sym = grid.at(pos);
     std::vector<Plot> plots; 
@@ -37,21 +38,15 @@ int region_price(const Grid<char>& grid, Grid<int>& visited, const Vec2& pos, bo
             continue;
         }
         visited.at(cur_pos) = 1;
-        plots.push_back(Plot{.pos = cur_pos, .num_fences = 4});
+        plots.push_back(Plot{.pos = cur_pos, .num_fences = fences.at(cur_pos)});
 
-        int num_adjacent = 0;
         constexpr std::array<Vec2, 4> dirs = aocutil::all_dirs_vec2<int>();
         for (const Vec2 dir: dirs) { // For all adjacent plots. 
             const Vec2 adj_pos = cur_pos + dir; 
-            if (auto adj_sym = grid.try_get(adj_pos); adj_sym.has_value() && adj_sym.value() == plant_sym) {
-                ++num_adjacent;
-                if (!visited.at(adj_pos)) {
-                    s.push(adj_pos);
-                }
+            if (auto adj_sym = grid.try_get(adj_pos); adj_sym.has_value() && adj_sym.value() == plant_sym && !visited.at(adj_pos)) {
+                s.push(adj_pos);
             }
         }
-        assert(num_adjacent <= 4);
-        plots.back().num_fences = 4 - num_adjacent;
     }
 
     const int area = std::ssize(plots);
@@ -131,11 +126,20 @@ int part_one(const std::vector<std::string>& lines, bool discount = false)
 {
     const Grid<char> garden{lines}; 
     Grid<int> visited(garden.width(), garden.height(), 0); // Grid<int> and not Grid<bool> because std::vector<bool> is evil...
+
+    // Number of fences of every plot, i.e. the number of its neighbours (including the ones outside of the garden) with a different plant.
+    const aocutil::Stencil<char> fence_stencil = {
+        {.offset = {1, 0}, .compare = aocutil::Stencil<char>::Compare::NotEqualCenter},
+        {.offset = {-1, 0}, .compare = aocutil::Stencil<char>::Compare::NotEqualCenter},
+        {.offset = {0, 1}, .compare = aocutil::Stencil<char>::Compare::NotEqualCenter},
+        {.offset = {0, -1}, .compare = aocutil::Stencil<char>::Compare::NotEqualCenter},
+    };
+    const Grid<int> fences = aocutil::stencil_apply(garden, fence_stencil, '\0');
     
     int total_price = 0; 
-    garden.foreach([&garden, &visited, &total_price, discount](const Vec2& pos, char elem) {
+    garden.foreach([&garden, &fences, &visited, &total_price, discount](const Vec2& pos, char elem) {
         if (!visited.at(pos)) {
-            total_price += region_price(garden, visited, pos, discount); 
+            total_price += region_price(garden, fences, visited, pos, discount); 
         }
     });
     return total_price;
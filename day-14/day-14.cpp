@@ -1,6 +1,9 @@
 #include "aoclib/grid.hpp"
+#include "aoclib/hashed-grid.hpp"
+#include "aoclib/occupancy-pyramid.hpp"
 #include "aoclib/aocio.hpp"
 #include "aoclib/vec.hpp"
+#include "aoclib/vec2-array.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/14
@@ -18,6 +21,7 @@
 */
 
 using Vec2 = aocutil::Vec2<int>;
+using Vec2Array = aocutil::Vec2Array<int>;
 
 struct Robot {
     Vec2 pos, vel;
@@ -70,60 +74,44 @@ struct RobotParser : public aocio::RDParser
     }
 };
 
-Vec2 simulate_robot(const Robot& bot, const Vec2& grid, int seconds)
+// Positions and velocities of all robots as structure-of-arrays, so all robots are moved at once with vectorised loops.
+void robot_arrays(const std::vector<Robot>& robots, Vec2Array& positions, Vec2Array& velocities)
 {
-    Vec2 new_pos;  
-    new_pos.x = (bot.pos.x + bot.vel.x * seconds) % grid.x;
-    new_pos.y = (bot.pos.y + bot.vel.y * seconds) % grid.y;
-    if (new_pos.x < 0) {
-        new_pos.x += grid.x;
+    positions.clear();
+    velocities.clear();
+    for (const Robot& bot : robots) {
+        positions.push_back(bot.pos);
+        velocities.push_back(bot.vel);
     }
-    if (new_pos.y < 0) {
-        new_pos.y += grid.y;
-    }
-    return new_pos;
 }
 
-std::array<int, 4> quadrant_counts(const std::vector<Vec2>& positions, const Vec2& grid)
+std::array<int, 4> quadrant_counts(const Vec2Array& positions, const Vec2& grid)
 {
-    std::array<int, 4> quadrant_cnt = {0, 0, 0, 0};
-    for (const Vec2& pos: positions) {
-        if (pos.x < grid.x / 2) { // Left
-            if (pos.y < grid.y / 2) { // Left-Top
-                quadrant_cnt.at(0) += 1;
-            } else if (pos.y > grid.y / 2) { // Left-Bottom
-                quadrant_cnt.at(1) += 1;
-            }
-        } 
-        else if (pos.x > grid.x / 2) { // Right
-            if (pos.y < grid.y / 2) { // Right-Top
-                quadrant_cnt.at(2) += 1;
-            } else if (pos.y > grid.y / 2) { // Right-Bottom
-                quadrant_cnt.at(3) += 1;
-            }
-        } 
-    }
-    return quadrant_cnt;
+    const Vec2 mid = {grid.x / 2, grid.y / 2}; // Robots exactly in the middle (horizontally or vertically) don't count.
+    return {
+        static_cast<int>(positions.count_in_rect({0, 0}, mid)),                                  // Left-Top
+        static_cast<int>(positions.count_in_rect({0, mid.y + 1}, {mid.x, grid.y})),              // Left-Bottom
+        static_cast<int>(positions.count_in_rect({mid.x + 1, 0}, {grid.x, mid.y})),              // Right-Top
+        static_cast<int>(positions.count_in_rect({mid.x + 1, mid.y + 1}, grid)),                 // Right-Bottom
+    };
 }
 
 int part_one(const std::vector<std::string>& lines)
 {
     constexpr int elapsed_seconds = 100; 
     constexpr Vec2 grid = {101, 103}; // Example: {11, 7}
-    std::vector<Robot> robots = RobotParser(lines).parse();
-    std::vector<Vec2> end_positions;
-    std::transform(robots.cbegin(), robots.cend(), std::back_inserter(end_positions), [grid](const Robot& bot) {
-        return simulate_robot(bot, grid, elapsed_seconds);
-    });
+    Vec2Array positions, velocities;
+    robot_arrays(RobotParser(lines).parse(), positions, velocities);
+    positions.add_scaled(velocities, elapsed_seconds).wrap(grid);
     
     int safety_factor = 1; 
-    for (int cnt : quadrant_counts(end_positions, grid)) {
+    for (int cnt : quadrant_counts(positions, grid)) {
         safety_factor *= cnt;
     }
     return safety_factor;
 }
 
-void print_grid(const Vec2& grid, const std::vector<Vec2>& positions)
+void print_grid(const Vec2& grid, const Vec2Array& positions)
 {
     aocutil::Grid<char> map(grid.x, grid.y, '.');
     for (const Vec2& pos: positions) {
@@ -136,34 +124,46 @@ int part_two(const std::vector<std::string>& lines)
 {
     constexpr int HEURISTIC_ROW_LENGTH = 16;
     constexpr Vec2 grid = {101, 103}; // Example: {11, 7}, Real: {101, 103}
-    std::vector<Robot> robots = RobotParser(lines).parse();
+    Vec2Array positions, velocities;
+    robot_arrays(RobotParser(lines).parse(), positions, velocities);
+    velocities.wrap(grid); // Velocities in [0, grid): After one second, every position is in [0, 2 * grid), so wrap_once suffices.
+    Vec2Array next_positions = positions;
+
+    aocutil::HashedGrid<int> robot_counts(grid.x, grid.y, 0); // Updated incrementally (instead of re-rasterising every second).
+    aocutil::OccupancyPyramid occupied(grid.x, grid.y); // Cells with at least one robot; the row scans only look at 8x8 blocks with at least 8 robots.
+    for (const Vec2 pos : positions) {
+        robot_counts.set(pos, robot_counts.get(pos) + 1);
+        occupied.set(pos, true);
+    }
+    const aocutil::HashedGrid<int> initial_counts = robot_counts;
+    const Vec2Array initial_positions = positions;
 
     for (int elapsed_seconds = 0; ; ++elapsed_seconds) {
-        std::vector<Vec2> positions;
-        std::transform(robots.cbegin(), robots.cend(), std::back_inserter(positions), [grid, elapsed_seconds](const Robot& bot) {
-            return simulate_robot(bot, grid, elapsed_seconds);
-        }); 
-
-        aocutil::Grid<char> map(grid.x, grid.y, '.');
-        for (const Vec2& pos: positions) {
-            map.at(pos) = 'x'; 
-        }       
-
-        for (int y = 0; y < map.height(); ++y) {
-            int consecutive = 0, max_consecutive = 0;
-            for (int x = 1; x < map.width(); ++x) {
-                if (map.at(x, y) == 'x' && map.at(x - 1, y) == 'x') {
-                    ++consecutive;
-                } else {
-                    max_consecutive = std::max(max_consecutive, consecutive);
-                    consecutive = 0;
-                }
-            }
-            if (max_consecutive >= HEURISTIC_ROW_LENGTH) {
+        // Every robot moves periodically, so the whole field does as well, and it returns to its initial state after at most grid.x * grid.y seconds.
+        // Equal counts don't mean equal positions (robots can swap cells), so the counts (O(1) to compare unless their hashes
+        // match) only filter the exact comparison of the positions.
+        if (elapsed_seconds > 0 && robot_counts == initial_counts && positions == initial_positions) {
+            throw std::runtime_error("part_two: The robots are back at their initial positions without having formed a christmas tree.");
+        }
+
+        for (int y = 0; y < robot_counts.height(); ++y) {
+            if (occupied.find_run_in_row(y, HEURISTIC_ROW_LENGTH + 1).has_value()) {
                 print_grid(grid, positions);
                 return elapsed_seconds;
             }    
         } 
+
+        next_positions = positions;
+        next_positions += velocities;
+        next_positions.wrap_once(grid);
+        for (std::size_t i = 0; i < positions.size(); ++i) { // The grid updates are scattered writes, so they stay scalar.
+            const Vec2 pos = positions[i], new_pos = next_positions[i];
+            robot_counts.set(pos, robot_counts.get(pos) - 1);
+            robot_counts.set(new_pos, robot_counts.get(new_pos) + 1);
+            occupied.set(pos, robot_counts.get(pos) > 0);
+            occupied.set(new_pos, true);
+        }
+        std::swap(positions, next_positions);
     }
     return 0;
 }
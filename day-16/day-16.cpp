@@ -1,7 +1,10 @@
-#include <queue>
+#include <stack>
 #include <unordered_set>
 #include "aoclib/aocio.hpp"
 #include "aoclib/grid.hpp"
+#include "aoclib/multi-grid.hpp"
+#include "aoclib/prio-queue.hpp"
+#include "aoclib/bucket-queue.hpp"
 
 /*
     Problem: https://adventofcode.com/2024/day/16
@@ -19,6 +22,7 @@ using aocutil::Grid;
 
 typedef int score_int_t;
 constexpr score_int_t INFINITY_SCORE = std::numeric_limits<score_int_t>::max();
+constexpr score_int_t TURN_COST = 1000, FORWARD_COST = 1;
 
 struct ReindeerState 
 {
@@ -31,56 +35,63 @@ struct ReindeerState
     }
 }; 
 
-class StateCell 
+/*
+    Per tile: The lowest score for each of the 4 directions the reindeer can face, followed by a bitmask of the predecessor 
+    states (on cheapest paths) for each direction, all in one contiguous MultiGrid (instead of a Grid of std::vectors per tile).
+*/
+enum class StateChannel {ScoreUp, ScoreRight, ScoreDown, ScoreLeft, PrevUp, PrevRight, PrevDown, PrevLeft};
+using StateGrid = aocutil::MultiGrid<score_int_t, 8, StateChannel>;
+
+constexpr score_int_t PREV_FORWARD = 1 << 4; // Predecessor bitmask: Bit n (n < 4) is set if the reindeer turned here from direction n, PREV_FORWARD if it moved here from the previous tile.
+
+int dir_idx(const Vec2& dir) 
 {
-    std::vector<ReindeerState> states;
-    std::vector<std::vector<ReindeerState>> prev_states;
+    return static_cast<int>(aocutil::vec2_to_dir(dir));
+}
 
-    public:
-    score_int_t get_cost(const ReindeerState& state) const
-    {
-        const auto it = std::find(states.cbegin(), states.cend(), state); 
-        if (it == states.cend()) {
-            return INFINITY_SCORE;
-        } else {
-            return it->score;
-        }
-    }
+score_int_t& state_score(StateGrid& state_grid, const ReindeerState& state) 
+{
+    return state_grid.at(state.pos, static_cast<StateChannel>(dir_idx(state.dir)));
+}
 
-    void update_cost(const ReindeerState& state)
-    {
-        const auto it = std::find(states.begin(), states.end(), state); 
-        if (it == states.end()) {
-            states.push_back(state);
-            prev_states.push_back({});
-        } else {
-            it->score = state.score;
-        }
-        assert(states.size() <= 4);
-        assert(states.size() == prev_states.size());
-    }
+score_int_t& state_prev(StateGrid& state_grid, const ReindeerState& state) 
+{
+    return state_grid.at(state.pos, static_cast<StateChannel>(4 + dir_idx(state.dir)));
+}
 
-    bool contains(const ReindeerState& state) const
-    {
-        return std::find(states.cbegin(), states.cend(), state) != states.cend(); 
-    }
+// Dense id of a state (position and direction, not the score) for the priority queue.
+uint32_t state_id(const Grid<char>& map, const ReindeerState& state)
+{
+    return static_cast<uint32_t>((state.pos.y * map.width() + state.pos.x) * 4 + dir_idx(state.dir));
+}
 
-    std::vector<ReindeerState>& get_prev_states(const ReindeerState& state) 
-    {
-        const auto it = std::find(states.cbegin(), states.cend(), state); 
-        if (it == states.cend()) {
-            throw std::runtime_error("get_prev_states: state not in .states");
-        } else {
-            std::ptrdiff_t idx = it - states.cbegin();
-            return prev_states.at(idx);
-        }
+ReindeerState state_from_id(const Grid<char>& map, uint32_t id, score_int_t score)
+{
+    const int tile_idx = static_cast<int>(id / 4);
+    return ReindeerState{.pos = {tile_idx % map.width(), tile_idx / map.width()}, .dir = aocutil::dir_to_vec2<int>(static_cast<aocutil::Direction>(id % 4)), .score = score};
+}
+
+/*
+    Queue: Min-priority queue of state ids with decrease-key and the interface of aocutil::PrioQueue (insert_or_update,
+    extract_min(prio)). The scores only grow and differ by at most TURN_COST, so the bucket queues of bucket-queue.hpp
+    (DialQueue, RadixHeap) apply; PrioQueue<uint32_t, score_int_t> works as well.
+*/
+template<typename Queue>
+Queue make_state_queue(std::size_t num_states)
+{
+    if constexpr (std::is_same_v<Queue, aocutil::DialQueue<score_int_t>>) {
+        return Queue(num_states, TURN_COST);
+    } else if constexpr (std::is_constructible_v<Queue, std::size_t>) {
+        return Queue(num_states);
+    } else {
+        return Queue{};
     }
-};
+}
 
+template<typename Queue = aocutil::DialQueue<score_int_t>>
 score_int_t find_cheapest_path(const Grid<char>& map, const Vec2& start_pos, const Vec2& end_pos, std::unordered_set<Vec2>* shortest_paths_tiles = nullptr)
 {
     const auto adjacent_states = [&map](const ReindeerState& r) {
-        constexpr score_int_t TURN_COST = 1000, FORWARD_COST = 1;
         std::vector<ReindeerState> adjacent;
 
         const Vec2 dir_left = r.dir.perp_dot(), dir_right = r.dir.perp_dot(false);
@@ -98,29 +109,27 @@ score_int_t find_cheapest_path(const Grid<char>& map, const Vec2& start_pos, con
         return adjacent;
     };
 
-   /*
-        Note: Dijkstra implemented using std::priority_queue which does not have "update-priority" functionality:
-        cf. https://github.com/zeichensystem/advent-of-code-2023/blob/main/day-17/day-17.cpp#L142 (last retrieved 2024-12-18)
-            https://cs.stackexchange.com/questions/118388/dijkstra-without-decrease-key (last retrieved 2024-12-18)
+    /*
+        Dijkstra with decrease-key (every state is in the queue at most once, with its current score), unlike the lazy
+        deletion a std::priority_queue needs, which leaves stale entries in the queue:
+        cf. https://cs.stackexchange.com/questions/118388/dijkstra-without-decrease-key (last retrieved 2024-12-18)
     */
-    const auto prio_cmp = [](const ReindeerState& a, const ReindeerState& b) { return a.score > b.score; }; // Min-prio-queue (.top() yields state with lowest score)
-    std::priority_queue<ReindeerState, std::vector<ReindeerState>, decltype(prio_cmp)> queue(prio_cmp);
-    queue.push(ReindeerState{.pos = start_pos, .dir = {1, 0}, .score = 0});
+    Queue queue = make_state_queue<Queue>(static_cast<std::size_t>(map.width()) * map.height() * 4);
+    const ReindeerState start_state{.pos = start_pos, .dir = {1, 0}, .score = 0};
+    queue.insert_or_update(state_id(map, start_state), start_state.score);
 
-    Grid<StateCell> state_grid(map.width(), map.height(), StateCell{});
-    state_grid.at(start_pos).update_cost(queue.top());
+    StateGrid state_grid(map.width(), map.height(), INFINITY_SCORE);
+    map.foreach([&state_grid](const Vec2& pos, char tile) {
+        const auto channels = state_grid.channels(pos);
+        std::fill(channels.begin() + static_cast<int>(StateChannel::PrevUp), channels.end(), 0); // No predecessors yet.
+    });
+    state_score(state_grid, start_state) = start_state.score;
 
     while (!queue.empty()) { 
-        const ReindeerState current_state = queue.top();
-        queue.pop();
-
-        const int current_score_queue = current_state.score;
-        const int current_score = state_grid.at(current_state.pos).get_cost(current_state); // The actual score.
-
-        if (current_score_queue != current_score) { // The current state was already in queue with a lower score (i.e. higher priority); cf. links above.
-            assert(current_score_queue > current_score);
-            continue;
-        }
+        score_int_t current_score = 0;
+        const uint32_t current_id = queue.extract_min(current_score);
+        const ReindeerState current_state = state_from_id(map, current_id, current_score);
+        assert(current_score == state_score(state_grid, current_state));
 
         if (current_state.pos == end_pos) {
             if (shortest_paths_tiles) { // Part 2: Depth-first traversal of the previous states.
@@ -130,8 +139,14 @@ score_int_t find_cheapest_path(const Grid<char>& map, const Vec2& start_pos, con
                     const ReindeerState state = s.top(); 
                     s.pop();
                     shortest_paths_tiles->insert(state.pos);
-                    for (ReindeerState prev_state : state_grid.at(state.pos).get_prev_states(state)) {
-                        s.push(prev_state);
+                    const score_int_t prev_mask = state_prev(state_grid, state);
+                    for (const Vec2& dir : aocutil::all_dirs_vec2<int>()) {
+                        if (prev_mask & (1 << dir_idx(dir))) {
+                            s.push(ReindeerState{.pos = state.pos, .dir = dir});
+                        }
+                    }
+                    if (prev_mask & PREV_FORWARD) {
+                        s.push(ReindeerState{.pos = state.pos - state.dir, .dir = state.dir});
                     }
                 }
             }
@@ -139,17 +154,18 @@ score_int_t find_cheapest_path(const Grid<char>& map, const Vec2& start_pos, con
         }
 
         for (ReindeerState adj_state : adjacent_states(current_state)) {
-            const score_int_t current_min_score = state_grid.at(adj_state.pos).get_cost(adj_state);
+            score_int_t& current_min_score = state_score(state_grid, adj_state);
+            const score_int_t prev_min_score = current_min_score;
             if (adj_state.score < current_min_score) {
-                state_grid.at(adj_state.pos).update_cost(adj_state);
-                queue.push(adj_state); // std::priority_queue has no "update priority" functionality, thus we just push a new state with the new, lower score; cf. links above.
+                current_min_score = adj_state.score;
+                queue.insert_or_update(state_id(map, adj_state), adj_state.score);
             } 
-            if (adj_state.score <= current_min_score && shortest_paths_tiles)  { // Part 2: ('<=' and not '<' because we need the prev states for all shortest paths and not just one).
-                std::vector<ReindeerState>& prev_states = state_grid.at(adj_state.pos).get_prev_states(adj_state);
-                if (adj_state.score < current_min_score) {
-                    prev_states.clear();
+            if (adj_state.score <= prev_min_score && shortest_paths_tiles)  { // Part 2: ('<=' and not '<' because we need the prev states for all shortest paths and not just one).
+                score_int_t& prev_mask = state_prev(state_grid, adj_state);
+                if (adj_state.score < prev_min_score) {
+                    prev_mask = 0;
                 }
-                prev_states.push_back(current_state);
+                prev_mask |= adj_state.pos == current_state.pos ? (1 << dir_idx(current_state.dir)) : PREV_FORWARD;
             }
         }
     }